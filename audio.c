@@ -0,0 +1,100 @@
+#include <math.h>
+#include <string.h>
+#include "audio.h"
+
+#define PATTERN_BITS 128
+
+/* Fills synth->table with one cycle made of the given harmonic amplitudes (sine and cosine parts),
+   dropping every harmonic at or above Nyquist so the tone does not alias, then normalizes to full scale */
+static void build_table(synth_t *synth, const double sin_amp[], const double cos_amp[], int harmonics,
+    double cycle_hz, int sample_rate) {
+    double sine[WAVETABLE_SIZE];
+    double wave[WAVETABLE_SIZE] = {0};
+    double peak = 0;
+
+    // Highest harmonic that stays below Nyquist
+    int max_harmonic = harmonics;
+    while (max_harmonic > 0 && max_harmonic * cycle_hz >= sample_rate / 2.0) {
+        max_harmonic--;
+    }
+
+    for (int n = 0; n < WAVETABLE_SIZE; n++) {
+        sine[n] = sin(2 * M_PI * n / WAVETABLE_SIZE);
+    }
+
+    // Additive synthesis; Lanczos sigma factors tame the Gibbs ringing from the truncated series
+    for (int k = 1; k <= max_harmonic; k++) {
+        const double x = M_PI * k / (max_harmonic + 1);
+        const double sigma = sin(x) / x;
+        for (int n = 0; n < WAVETABLE_SIZE; n++) {
+            wave[n] += sigma * (sin_amp[k] * sine[(k * n) % WAVETABLE_SIZE] +
+                cos_amp[k] * sine[(k * n + WAVETABLE_SIZE / 4) % WAVETABLE_SIZE]);
+        }
+    }
+
+    for (int n = 0; n < WAVETABLE_SIZE; n++) {
+        peak = fmax(peak, fabs(wave[n]));
+    }
+    for (int n = 0; n < WAVETABLE_SIZE; n++) {
+        synth->table[n] = peak > 0 ? (int16_t)(wave[n] / peak * 32767) : 0;
+    }
+
+    synth->step = (uint32_t)(cycle_hz / sample_rate * 4294967296.0);
+}
+
+/* Selects the waveform to play: the XO-CHIP 128-bit pattern at the given pitch register value,
+   or the classic 440Hz square if pattern is NULL. Only rebuilds the table if the source changed;
+   Returns true if it did. Rebuilding is slow, so keep it off the audio thread */
+bool synth_configure(synth_t *synth, const uint8_t pattern[16], uint8_t pitch, int sample_rate) {
+    double sin_amp[PATTERN_BITS / 2 + 1] = {0};
+    double cos_amp[PATTERN_BITS / 2 + 1] = {0};
+    const bool xo = pattern != NULL;
+
+    if (synth->built && synth->xo == xo &&
+        (!xo || (synth->pitch == pitch && memcmp(synth->pattern, pattern, sizeof(synth->pattern)) == 0))) {
+        return false;
+    }
+
+    if (xo) {
+        // Pattern bits play at 4000 * 2^((pitch - 64) / 48) bits per second, MSB of byte 0 first.
+        // Its Fourier series (DC dropped) gives the harmonic amplitudes of one 128-bit cycle
+        double pattern_sine[PATTERN_BITS];
+        for (int n = 0; n < PATTERN_BITS; n++) {
+            pattern_sine[n] = sin(2 * M_PI * n / PATTERN_BITS);
+        }
+        for (int k = 1; k <= PATTERN_BITS / 2; k++) {
+            for (int n = 0; n < PATTERN_BITS; n++) {
+                const double level = ((pattern[n / 8] >> (7 - n % 8)) & 1) ? 1.0 : -1.0;
+                sin_amp[k] += level * pattern_sine[(k * n) % PATTERN_BITS];
+                cos_amp[k] += level * pattern_sine[(k * n + PATTERN_BITS / 4) % PATTERN_BITS];
+            }
+        }
+        const double bit_rate = 4000.0 * pow(2.0, (pitch - 64) / 48.0);
+        build_table(synth, sin_amp, cos_amp, PATTERN_BITS / 2, bit_rate / PATTERN_BITS, sample_rate);
+        memcpy(synth->pattern, pattern, sizeof(synth->pattern));
+    } else {
+        // Square wave: odd harmonics at 1/k
+        for (int k = 1; k <= PATTERN_BITS / 2; k += 2) {
+            sin_amp[k] = 1.0 / k;
+        }
+        build_table(synth, sin_amp, cos_amp, PATTERN_BITS / 2, CLASSIC_TONE_HZ, sample_rate);
+    }
+
+    synth->xo = xo;
+    synth->pitch = pitch;
+    synth->built = true;
+    return true;
+}
+
+/* Renders samples from the current table scaled by volume; phase carries over between calls */
+void synth_render(synth_t *synth, int16_t *out, int samples, int32_t volume) {
+    const int16_t *table = synth->table;
+    const uint32_t step = synth->step;
+    uint32_t phase = synth->phase;
+
+    for (int i = 0; i < samples; i++) {
+        out[i] = (int16_t)((table[phase >> 24] * volume) >> 15);
+        phase += step;
+    }
+    synth->phase = phase;
+}
@@ -0,0 +1,26 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WAVETABLE_SIZE 256          // Samples per cycle; power of 2 so the phase accumulator indexes it with a shift
+#define CLASSIC_TONE_HZ 440.0       // Frequency of the original CHIP-8 beep
+
+/* Band-limited wavetable oscillator. Holds one cycle of the current waveform,
+   rebuilt only when the sound source changes, and a 32-bit phase accumulator
+   whose top 8 bits index the table */
+typedef struct {
+    int16_t table[WAVETABLE_SIZE];
+    uint32_t phase;
+    uint32_t step;                  // Phase increment per output sample
+    bool built;
+    bool xo;                        // Cached source: XO-CHIP pattern or classic square
+    uint8_t pattern[16];
+    uint8_t pitch;
+} synth_t;
+
+bool synth_configure(synth_t *synth, const uint8_t pattern[16], uint8_t pitch, int sample_rate);
+void synth_render(synth_t *synth, int16_t *out, int samples, int32_t volume);
+
+#endif
@@ -0,0 +1,714 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chip8.h"
+
+/* Clears every field in CHIP-8 struct to its power-on value; Loads font into RAM */
+void reset_chip8(chip8_t *chip8) {
+    const uint8_t font[] = {
+        0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
+        0x20, 0x60, 0x20, 0x20, 0x70, // 1
+        0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
+        0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
+        0x90, 0x90, 0xF0, 0x10, 0x10, // 4
+        0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
+        0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
+        0xF0, 0x10, 0x20, 0x40, 0x40, // 7
+        0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
+        0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
+        0xF0, 0x90, 0xF0, 0x90, 0x90, // A
+        0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
+        0xF0, 0x80, 0x80, 0x80, 0xF0, // C
+        0xE0, 0x90, 0x90, 0x90, 0xE0, // D
+        0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
+        0xF0, 0x80, 0xF0, 0x80, 0x80  // F
+    };
+
+    // Set default fields for CHIP-8 object 
+    memset(chip8, 0, sizeof(*chip8));
+    chip8->state = RUNNING;         
+    chip8->volume = 1500;
+    chip8->pitch = 64;      // 4000 bits/sec, XO-CHIP's default playback rate
+    chip8->rng = 0x2545F491; // Any non-zero seed; callers wanting varied runs reseed it
+    chip8->PC = ENTRY_POINT;                          
+    memcpy(&chip8->ram[0], font, sizeof(font)); 
+}
+
+/* Copies a ROM image into RAM at the entry point; Fails if it cannot fit in memory */
+bool load_rom(chip8_t *chip8, const uint8_t *rom, size_t rom_size) {
+    if (rom_size > sizeof(chip8->ram) - ENTRY_POINT) {
+        return false;
+    }
+    memcpy(&chip8->ram[ENTRY_POINT], rom, rom_size);
+    return true;
+}
+
+/* Initializes all necessary fields in CHIP-8 struct; Loads font and user-given ROM file into RAM */
+bool initialize_chip8(chip8_t *chip8, const char rom_name[]) {
+    uint8_t rom_data[RAM_SIZE - ENTRY_POINT];
+
+    reset_chip8(chip8);
+
+    // Open user-given ROM file 
+    FILE *rom = fopen(rom_name, "rb");   
+    if (rom == false) {
+        printf("ROM file %s does not exist or is invalid\n", rom_name);
+        return false;
+    }
+
+    // Find length of ROM file; confirm file can fit in memory
+    fseek(rom, 0, SEEK_END);
+    const size_t rom_size = ftell(rom);
+    const size_t max_size = sizeof(rom_data);
+    fseek(rom, 0, SEEK_SET);
+    
+    if (rom_size > max_size) {
+        printf("ROM File %s is too large. File size: %zu, Max Size: %zu\n", rom_name, rom_size, max_size);
+        fclose(rom);
+        return false;
+    }
+
+    // Read contents of ROM file into CHIP-8 RAM
+    if (fread(rom_data, sizeof(uint8_t), rom_size, rom) != rom_size || !load_rom(chip8, rom_data, rom_size)) {
+        printf("Failure ocurred when writing ROM file into CHIP-8 memory\n");
+        fclose(rom);
+        return false;
+    }
+    fclose(rom);
+
+    return true;
+}
+
+/* Returns the next instruction contained in the ROM. Each instruction is 2 bytes. Increments PC by 2.
+   Stops emulation if PC has run off the end of RAM */
+uint16_t fetch_instruction(chip8_t *chip8) {
+    if (chip8->PC > RAM_SIZE - 2) {
+        chip8->state = QUIT;
+        chip8->fault = PC_OUT_OF_RANGE;
+        return 0x0000;
+    }
+
+    uint16_t instr = ((chip8->ram[chip8->PC] << 8) | (chip8->ram[chip8->PC + 1]));
+    chip8->PC += 2; // Increment PC for next instruction execution cycle 
+    return instr;
+}
+
+#ifdef DEBUG
+    void print_debugging(chip8_t *chip8, uint16_t opcode) {
+
+        uint16_t NNN = opcode & 0x0FFF;     
+        uint8_t NN = opcode & 0x00FF;       
+        uint8_t N = opcode & 0x000F;        
+        uint8_t X = (opcode >> 8) & 0x000F; 
+        uint8_t Y = (opcode >> 4) & 0x000F; 
+
+        switch (opcode >> 12) {
+        case 0x0000: 
+            switch (NN) {
+                case 0xE0:      // 00E0: Clear the display 
+                    printf("00E0: Clear the display\n");
+                    break;
+
+                case 0xEE:      // 00EE: Return from a subroutine
+                    if (chip8->stack_size > 0) {
+                        printf("00EE: Return from a subroutine to address 0x%04X. Stack size is now %d\n", 
+                            chip8->stack[chip8->stack_size - 1], chip8->stack_size - 1);
+                    } else {
+                        printf("00EE: Return from a subroutine with an empty stack\n");
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+
+        case 0x0001:            // 1NNN: Jump to location NNN 
+            printf("1NNN: Jump to location 0x%04X\n", NNN);
+            break;
+
+        case 0x0002:            // 2NNN: Call subroutine at NNN 
+            printf("2NNN: Call subroutine at 0x%04X. Stack size is now %d\n", NNN, chip8->stack_size);
+            break;                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                              
+
+        case 0x0003:            // 3XNN: Skip next instruction if VX = NN 
+            printf("3XNN: Skip next instruction if V%X (0x%02X) = NN (0x%02X)",
+                X, chip8->V[X], NN);
+            break;
+
+        case 0x0004:            // 4XNN: Skip next instruction if VX != NN 
+            printf("4XNN: Skip next instruction if V%X (0x%02X) != NN (0x%02X)",
+                X, chip8->V[X], NN);
+            break;
+
+        case 0x0005:            // 5XY0: Skip next instruction if VX = VY 
+            printf("5XY0: Skip next instruction if V%X (0x%02X) = V%X (0x%02X)\n",
+                X, chip8->V[X], Y, chip8->V[Y]);
+            break;
+
+        case 0x0006:            // 6XNN: Set VX = NN 
+            printf("6XNN: Set V%X = NN (0x%02X)\n", X, NN);
+            break;
+
+        case 0x0007:            // 7XNN: Set VX = VX + NN 
+            printf("7XNN: Set V%X += NN (0x%02X). Result: 0x%02X\n", X, NN, 
+                chip8->V[X] + NN);
+            break;
+
+        case 0x0008:
+            switch(N) {
+                case 0x0:       // 8XY0: Set VX = VY 
+                    printf("8XY0: Set V%X = V%X\n", X, Y);
+                    break;
+
+                case 0x1:       // 8XY1: Set VX = VX OR VY 
+                    printf("8XY1: Set V%X |= V%X. Result: 0x%02X\n", 
+                        X, Y, chip8->V[X] | chip8->V[Y]);
+                    break;
+
+                case 0x2:       // 8XY2: Set VX = VX AND VY 
+                    printf("8XY2: Set V%X &= V%X. Result: 0x%02X\n", 
+                        X, Y, chip8->V[X] & chip8->V[Y]);
+                    break;
+
+                case 0x3:       // 8XY3: Set VX = VX XOR VY 
+                     printf("8XY2: Set V%X ^= V%X. Result: 0x%02X\n", 
+                        X, Y, chip8->V[X] ^ chip8->V[Y]);
+                    break;
+
+                case 0x4:       // 8XY4: Set VX += VY, set VF = carry
+                    printf("8XY4: Set V%X (0x%02X) += V%X (0x%02X), set VF = carry. Results: 0x%02X, VF = %X\n",
+                        X, chip8->V[X], Y, chip8->V[Y], chip8->V[X] + chip8->V[Y], 
+                        ((uint16_t)(chip8->V[X] + chip8->V[Y]) > 255));
+                    break;
+
+                case 0x5:       // 8XY5: Set VX -= VY, set VF = NOT borrow
+                    printf("8XY5: Set V%X (0x%02X) -= V%X (0x%02X), set VF = NOT borrow. Results: 0x%02X, VF = %X\n",
+                        X, chip8->V[X], Y, chip8->V[Y], chip8->V[X] - chip8->V[Y], chip8->V[X] >= chip8->V[Y]);
+                    break;
+
+                case 0x6:       // 8XY6: Set VX = VX SHR 1. Set VF = 1 if MSB is 1 */
+                    printf("8XY6: Set V%X >>= 1. Set VF = 1 if shifted bit is 1. Results: 0x%02X, VF = %X\n",
+                        X, chip8->V[X] >> 1, chip8->V[X] & 1);
+                    break;
+
+                case 0x7:       // 8XY7: Set VX = VY - VX, set VF = NOT borrow 
+                    printf("8XY7: Set V%X = V%X - V%X, set VF = NOT borrow. Results: 0x%02X, VF = %X\n",
+                        X, Y, X, (uint8_t)(chip8->V[Y] - chip8->V[X]), (chip8->V[Y] >= chip8->V[X]));
+                    break;
+
+                case 0xE:       // 8XYE: Set VX = VX SHL 1. Set VF = 1 if MSB is 1 
+                    printf("8XYE: Set V%X <<= 1. Set VF = 1 if MSB is 1. Results: 0x%02X, VF = %X\n",
+                        X, chip8->V[X] << 1, chip8->V[X] >> 7);
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+
+        case 0x0009:            // 9XY0: Skip next instruction if VX != VY 
+            printf("9XY0: Skip next instruction if V%X (0x%02X) != V%X (0x%02X)\n",
+                X, chip8->V[X], Y, chip8->V[Y]);
+            break;
+
+        case 0x000A:            // ANNN: Set I = NNN 
+            printf("ANNN: Set I = 0x%04X\n", NNN);
+            break;
+        
+        case 0x000B:            // BNNN: Jump to location NNN + V0 
+            printf("Jump to location 0x%04X + V0 (0x%02X). Result: 0x%04X\n",
+                NNN, chip8->V[0], NNN + chip8->V[0]);
+            break;
+
+        case 0x000C:            // CXNN: Set VX = random byte & NN
+            printf("CXNN: Set V%X = random byte (xorshift32) & NN (0x%02X)\n", X, NN);
+            break;
+
+        case 0x000D:            // DXYN: Display N-byte sprite starting at memory location I at (X, Y), set VF = collision 
+            printf("DXYN: Draw N (%u) height sprite at X,Y (0x%02X, 0x%02X), starting at I (0x%04X). Set VF = collision.\n", 
+                N, chip8->V[X] % SCREEN_WIDTH, chip8->V[Y] % SCREEN_HEIGHT, chip8->I);
+            break;
+
+        case 0x000E:
+            switch (NN) {
+                case 0x9E:      // EX9E: Skip next instruction if key stored in VX is pressed
+                    printf("EX9E: Skip next instruction if key stored in V%X is pressed. Result: VX == 0x%02X\n",
+                        X, chip8->V[X]);
+                    break;
+
+                case 0xA1:      // EXA1: Skip next instruction if key stored in VX is not pressed
+                    printf("EXA1: Skip next instruction if key stored in V%X is not pressed. Result: VX == 0x%02X\n",
+                        X, chip8->V[X]);
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+
+        case 0x000F:
+            switch (NN) {
+                case 0x02:      // F002: Load 16-byte audio pattern starting at I (XO-CHIP)
+                    printf("F002: Load 16-byte audio pattern starting at I (0x%04X)\n", chip8->I);
+                    break;
+
+                case 0x07:      // FX07: Sets VX to the delay timer
+                    printf("FX07: Sets V%X to the delay timer (%u)\n", X, chip8->delay_timer);
+                    break;
+
+                case 0x0A:      // FX0A: Stop all execution until a key is pressed AND released. Store in VX
+                    printf("FX0A: Stop all execution until a key is pressed AND released. Store in V%X\n", X);
+                    break;
+
+                case 0x15:      // FX15: Sets the delay timer to VX
+                    printf("FX15: Sets the delay timer to V%X (0x%02X)\n", X, chip8->V[X]);
+                    break;
+
+                case 0x18:      // FX18: Sets the sound timer to VX
+                    printf("FX18: Sets the sound timer to V%X (0x%02X)\n", X, chip8->V[X]);
+                    break;
+
+                case 0x3A:      // FX3A: Set audio pitch register to VX (XO-CHIP)
+                    printf("FX3A: Set pitch register to V%X (0x%02X)\n", X, chip8->V[X]);
+                    break;
+
+                case 0x1E:      // FX1E: Set I += VX
+                    printf("FX1E: Set I (0x%04X) += V%X (0x%02X). Result: 0x%04X\n",
+                        chip8->I, X, chip8->V[X], chip8->I + chip8->V[X]);
+                    break;
+
+                case 0x29:      // FX29: Set I = location of sprite for the character in VX
+                    printf("FX29: Set I (0x%04X) = location of sprite for the character in V%X (0x%02X). Result: I = 0x%04X\n",
+                        chip8->I, X, chip8->V[X], chip8->V[X] * 5);
+                    break;
+
+                case 0x33:      // FX33: Extracts hundreds, tens, and ones digits of an
+                                // 8-bit number in VX to I, I + 1, I + 2
+                    printf("FX33: Extracts hundreds, tens, and ones digits of an 8-bit number in V%X (0x%02X) to I, I + 1, I + 2\n",
+                        X, chip8->V[X]);
+                    break;
+                    
+                case 0x55:      // FX55: Store registers V0 through VX in memory starting at location I
+                    printf("FX55: Store registers V0 through V%X in memory starting at location I (0x%04X)\n",
+                        X, chip8->I);
+                    break;
+                    
+                case 0x65:      // FX65: Read registers V0 through VX from memory starting at location I
+                    printf("FX65: Read registers V0 through V%X from memory starting at location I (0x%04X)\n",
+                        X, chip8->I);
+                    break;
+                    
+                default:
+                    break;
+            }
+            break;
+        
+        default:
+            printf("Unimplemented opcode: 0x%04X\n", opcode);
+        }
+    }
+#endif 
+
+/* Emulates the execution of one opcode */
+void execute_instruction(chip8_t *chip8) {
+    uint16_t opcode = fetch_instruction(chip8); 
+
+    #ifdef DEBUG
+        print_debugging(chip8, opcode);
+    #endif
+
+    // Get (maybe) necessary parts of the opcode 
+    uint16_t NNN = opcode & 0x0FFF;     // NNN is a 12-bit address
+    uint8_t NN = opcode & 0x00FF;       // NN is a 8-bit constant
+    uint8_t N = opcode & 0x000F;        // N is a 4-bit constant
+    uint8_t X = (opcode >> 8) & 0x000F; // X is a 4-bit register identifier
+    uint8_t Y = (opcode >> 4) & 0x000F; // Y is a 4-bit register identifier
+
+    // Emulate opcode
+    switch (opcode >> 12) {
+        case 0x0000: 
+            switch (NN) {
+                case 0xE0:      // 00E0: Clear the display 
+                    memset(&chip8->display[0], false, sizeof(chip8->display));
+                    chip8->display_dirty = true;
+                    break;
+
+                case 0xEE:      // 00EE: Return from a subroutine
+                    if (chip8->stack_size == 0) {
+                        chip8->state = QUIT;
+                        chip8->fault = STACK_UNDERFLOW;
+                        break;
+                    }
+                    chip8->PC = chip8->stack[chip8->stack_size - 1];
+                    chip8->stack_size--;
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+        
+        case 0x0001:            // 1NNN: Jump to location NNN
+            chip8->PC = NNN;
+            break;
+
+        case 0x0002:            // 2NNN: Call subroutine at NNN
+            if (chip8->stack_size == sizeof(chip8->stack) / sizeof(chip8->stack[0])) {
+                chip8->state = QUIT;
+                chip8->fault = STACK_OVERFLOW;
+                break;
+            }
+            chip8->stack[chip8->stack_size++] = chip8->PC;
+            chip8->PC = NNN;
+            break;                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                              
+
+        case 0x0003:            // 3XNN: Skip next instruction if VX = NN
+            if (chip8->V[X] == NN) {
+                chip8->PC += 2;
+            }
+            break;
+
+        case 0x0004:            // 4XNN: Skip next instruction if VX != NN 
+            if (chip8->V[X] != NN) {
+                chip8->PC += 2;
+            }
+            break;
+
+        case 0x0005:            // 5XY0: Skip next instruction if VX = VY 
+            if (chip8->V[X] == chip8->V[Y]) {
+                chip8->PC += 2;
+            }
+            break;
+
+        case 0x0006:            // 6XNN: Set VX = NN 
+            chip8->V[X] = NN;
+            break;
+
+        case 0x0007:            // 7XNN: Set VX = VX + NN 
+            chip8->V[X] += NN;
+            break;
+
+        case 0x0008:
+            switch(N) {
+                case 0x0:       // 8XY0: Set VX = VY 
+                    chip8->V[X] = chip8->V[Y];
+                    break;
+
+                case 0x1:       // 8XY1: Set VX = VX OR VY 
+                    chip8->V[X] = (chip8->V[X] | chip8->V[Y]);
+                    if (chip8->quirks & QUIRK_VF_RESET) {
+                        chip8->V[0xF] = 0;
+                    }
+                    break;
+
+                case 0x2:       // 8XY2: Set VX = VX AND VY 
+                    chip8->V[X] = (chip8->V[X] & chip8->V[Y]);
+                    if (chip8->quirks & QUIRK_VF_RESET) {
+                        chip8->V[0xF] = 0;
+                    }
+                    break;
+
+                case 0x3:       // 8XY3: Set VX = VX XOR VY 
+                    chip8->V[X] = (chip8->V[X] ^ chip8->V[Y]);
+                    if (chip8->quirks & QUIRK_VF_RESET) {
+                        chip8->V[0xF] = 0;
+                    }
+                    break;
+
+                case 0x4:       // 8XY4: Set VX = VX + VY, set VF = carry
+                    { 
+                    bool carry = ((uint16_t)(chip8->V[X] + chip8->V[Y]) > 255);
+                    chip8->V[X] += chip8->V[Y];
+                    chip8->V[0xF] = carry;
+                    break;
+                    }
+
+                case 0x5:       // 8XY5: Set VX = VX - VY, set VF = NOT borrow
+                    {
+                    bool carry = (chip8->V[X] >= chip8->V[Y]);
+                    chip8->V[X] -= chip8->V[Y];
+                    chip8->V[0xF] = carry;
+                    break;
+                    }
+
+                case 0x6:       // 8XY6: Set VX = VX SHR 1. Set VF = 1 if shifted bit is 1
+                    {
+                    if (chip8->quirks & QUIRK_SHIFT_VY) {
+                        chip8->V[X] = chip8->V[Y];
+                    }
+                    bool shifted_bit = chip8->V[X] & 1;
+                    chip8->V[X] >>= 1;
+                    chip8->V[0xF] = shifted_bit;
+                    break;
+                    }
+
+                case 0x7:       // 8XY7: Set VX = VY - VX, set VF = NOT borrow 
+                    {
+                    bool no_underflow = (chip8->V[Y] >= chip8->V[X]);
+                    chip8->V[X] = chip8->V[Y] - chip8->V[X];
+                    chip8->V[0xF] = no_underflow;
+                    break;
+                    }
+
+                case 0xE:       // 8XYE: Set VX = VX SHL 1. Set VF = 1 if MSB is 1 
+                    {
+                    if (chip8->quirks & QUIRK_SHIFT_VY) {
+                        chip8->V[X] = chip8->V[Y];
+                    }
+                    bool MSB = ((chip8->V[X] & 0x80) == 0x80);
+                    chip8->V[X] <<= 1;
+                    chip8->V[0xF] = MSB;
+                    break;
+                    }
+
+                default:
+                    break;
+            }
+            break;
+
+        case 0x0009:            // 9XY0: Skip next instruction if VX != VY 
+            if (chip8->V[X] != chip8->V[Y]) {
+                chip8->PC += 2;
+            }
+            break;
+
+        case 0x000A:            // ANNN: Set I = NNN 
+            chip8->I = NNN;
+            break;
+        
+        case 0x000B:            // BNNN: Jump to location NNN + V0 (BXNN: XNN + VX with QUIRK_JUMP_VX)
+            chip8->PC = chip8->V[(chip8->quirks & QUIRK_JUMP_VX) ? X : 0] + NNN;
+            break;
+
+        case 0x000C:            // CXNN: Set VX = random byte & NN, from the per-instance xorshift32 state
+            chip8->rng ^= chip8->rng << 13; // xorshift32
+            chip8->rng ^= chip8->rng >> 17;
+            chip8->rng ^= chip8->rng << 5;
+            chip8->V[X] = (chip8->rng % 256) & NN;
+            break;
+
+        case 0x000D:            // DXYN: Display N-byte sprite starting at memory location I at (X, Y), set VF = collision 
+            {
+            // Original hardware waited for the vertical blank before drawing; retry until the next frame
+            if (chip8->quirks & QUIRK_DISPLAY_WAIT) {
+                if (chip8->drew_this_frame) {
+                    chip8->PC -= 2;
+                    break;
+                }
+                chip8->drew_this_frame = true;
+            }
+
+            uint8_t x_coord = chip8->V[X] % SCREEN_WIDTH;
+            uint8_t y_coord = chip8->V[Y] % SCREEN_HEIGHT;
+            const uint8_t orig_x_coord = x_coord;
+            chip8->V[0xF] = 0;
+            chip8->display_dirty = true;
+
+            // Loop through all N rows of the sprite 
+            for (uint8_t j = 0; j < N; j++) {
+                const uint8_t sprite_data = chip8->ram[(chip8->I + j) & (RAM_SIZE - 1)]; // Get next byte of sprite data; addresses wrap at 4kb 
+                x_coord = orig_x_coord; // Reset x_coord for next row 
+
+                // Checks each bit from left to right of the current row 
+                for (int8_t k = 7; k >= 0; k--) {
+                    // Set VF (carry flag) to 1 if any pixel is erased from the screen 
+                    bool *pixel = &chip8->display[(y_coord * SCREEN_WIDTH) + x_coord];
+                    const bool sprite_bit = (sprite_data & (1 << k));
+
+                    if (sprite_bit && *pixel) {
+                        chip8->V[0xF] = 1;
+                    }
+
+                    // XOR sprite onto the existing display 
+                    *pixel ^= sprite_bit;
+
+                    // Stop drawing current row if you reach right edge of screen, or wrap around to the left edge
+                    if (++x_coord >= SCREEN_WIDTH) {
+                        if (!(chip8->quirks & QUIRK_SPRITE_WRAP)) {
+                            break;
+                        }
+                        x_coord = 0;
+                    }
+                }
+
+                // Stop ALL drawing if you reach bottom of screen, or wrap around to the top
+                if (++y_coord >= SCREEN_HEIGHT) {
+                    if (!(chip8->quirks & QUIRK_SPRITE_WRAP)) {
+                        break;
+                    }
+                    y_coord = 0;
+                }
+            }
+            break;
+            }
+
+        case 0x000E:
+            switch (NN) {
+                case 0x9E:      // EX9E: Skip next instruction if key stored in VX is pressed
+                    if (chip8->keypad[chip8->V[X] & 0xF]) {
+                        chip8->PC += 2;
+                    }
+                    break;
+
+                case 0xA1:      // EXA1: Skip next instruction if key stored in VX is not pressed
+                    if (!chip8->keypad[chip8->V[X] & 0xF]) {
+                        chip8->PC += 2;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+            break;
+
+        case 0x000F:
+            switch (NN) {
+                case 0x02:      // F002: Load 16-byte audio pattern starting at I (XO-CHIP)
+                    if (X == 0) {
+                        for (uint8_t i = 0; i < sizeof(chip8->audio_pattern); i++) {
+                            chip8->audio_pattern[i] = chip8->ram[(chip8->I + i) & (RAM_SIZE - 1)];
+                        }
+                        chip8->xo_audio = true;
+                    }
+                    break;
+
+                case 0x07:      // FX07: Sets VX to the delay timer
+                    chip8->V[X] = chip8->delay_timer;
+                    break;
+
+                case 0x0A:      // FX0A: Stop all execution until a key is pressed AND released. Store in VX
+                    {
+                    for (uint8_t i = 0; !chip8->wait_key_pressed && i < sizeof(chip8->keypad); i++) {
+                        if (chip8->keypad[i]) { // Check if key at current index is pressed
+                            chip8->wait_key = i;
+                            chip8->wait_key_pressed = true;
+                            break;
+                        }
+                    }
+
+                    if (!chip8->wait_key_pressed) {
+                        chip8->PC -= 2; // Repeats this instruction until a key is pressed
+                    } else {
+                        if (chip8->keypad[chip8->wait_key]) { // Key is still pressed
+                            chip8->PC -= 2;
+                        } else { // Key has been pressed and released
+                            chip8->V[X] = chip8->wait_key;
+                            chip8->wait_key_pressed = false;
+                        }
+                    }
+                    break;
+                    }
+
+                case 0x15:      // FX15: Sets the delay timer to VX
+                    chip8->delay_timer = chip8->V[X];
+                    break;
+
+                case 0x18:      // FX18: Sets the sound timer to VX
+                    chip8->sound_timer = chip8->V[X];
+                    break;
+
+                case 0x3A:      // FX3A: Set audio pitch register to VX (XO-CHIP)
+                    chip8->pitch = chip8->V[X];
+                    break;
+
+                case 0x1E:      // FX1E: Set I += VX
+                    chip8->I += chip8->V[X];
+                    break;
+
+                case 0x29:      // FX29: Set I = location of sprite for the character in VX
+                    chip8->I = chip8->V[X] * 5;
+                    break;
+
+                case 0x33:      // FX33: Extracts hundreds, tens, and ones digits of an
+                                // 8-bit number in VX to I, I + 1, I + 2
+                    {
+                    uint8_t num = chip8->V[X];
+                    chip8->ram[(chip8->I + 2) & (RAM_SIZE - 1)] = num % 10; // Ones place
+                    num /= 10;
+                    chip8->ram[(chip8->I + 1) & (RAM_SIZE - 1)] = num % 10; // Tens place
+                    num /= 10;
+                    chip8->ram[chip8->I & (RAM_SIZE - 1)] = num % 10;       // Hundreds place
+                    break;
+                    }   
+
+                case 0x55:      // FX55: Store registers V0 through VX in memory starting at location I
+                    {
+                    int8_t hex = 0x0;
+                    for (int8_t i = 0; i <= X; i++) {
+                        chip8->ram[(chip8->I + i) & (RAM_SIZE - 1)] = chip8->V[hex++];
+                    }
+                    if (chip8->quirks & QUIRK_LOAD_STORE_I) {
+                        chip8->I += X + 1;
+                    }
+                    break;
+                    }
+
+                case 0x65:      // FX65: Read registers V0 through VX from memory starting at location I
+                    {
+                    int8_t hex = 0x0;
+                    for (int8_t i = 0; i <= X; i++) {
+                        chip8->V[hex++] = chip8->ram[(chip8->I + i) & (RAM_SIZE - 1)];
+                    }
+                    if (chip8->quirks & QUIRK_LOAD_STORE_I) {
+                        chip8->I += X + 1;
+                    }
+                    break;
+                    }
+
+                default:
+                    break;
+            }
+            break;
+
+        default:
+            printf("Unimplemnted or Invalid opcode.\n");
+            break;
+    }
+    
+}
+
+/* Decrements timers by 60Hz if > 0 */
+void tick_timers(chip8_t *chip8) {
+    if (chip8->delay_timer > 0) {
+        chip8->delay_timer--;
+    }
+
+    if (chip8->sound_timer > 0) {
+        chip8->sound_timer--;
+    }
+
+    chip8->drew_this_frame = false; // Timers tick once per frame, i.e. on the vertical blank
+}
+
+/* Emulates one 60Hz frame without any SDL involvement: one batch of instructions, then a timer tick */
+void run_frame(chip8_t *chip8) {
+    for (uint32_t i = 0; i < INSTRUCTIONS_PER_FRAME && chip8->state != QUIT; i++) {
+        execute_instruction(chip8);
+    }
+    tick_timers(chip8);
+}
+
+/* Human readable description of why emulation was stopped */
+const char *fault_name(emu_fault fault) {
+    switch (fault) {
+        case NO_FAULT:        return "no fault";
+        case STACK_OVERFLOW:  return "stack overflow (2NNN with 16 nested subroutines)";
+        case STACK_UNDERFLOW: return "stack underflow (00EE with no subroutine to return from)";
+        case PC_OUT_OF_RANGE: return "program counter ran past the end of RAM";
+        default:              return "unknown fault";
+    }
+}
+
+/* Short name for a single quirk flag */
+const char *quirk_name(quirk_flags quirk) {
+    switch (quirk) {
+        case QUIRK_SHIFT_VY:     return "shift-vy";
+        case QUIRK_LOAD_STORE_I: return "load-store-i";
+        case QUIRK_JUMP_VX:      return "jump-vx";
+        case QUIRK_VF_RESET:     return "vf-reset";
+        case QUIRK_SPRITE_WRAP:  return "sprite-wrap";
+        case QUIRK_DISPLAY_WAIT: return "display-wait";
+        default:                 return "unknown";
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef CHIP8_H
+#define CHIP8_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#define SCREEN_WIDTH 64
+#define SCREEN_HEIGHT 32
+#define RAM_SIZE 4096
+#define ENTRY_POINT 0x200                   // Standard starting point in memory for all CHIP-8 programs
+#define INSTRUCTIONS_PER_FRAME (500 / 60)   // Run ~500 instructions per second at 60fps
+
+/* Used to define current state of Chip-8 object */
+typedef enum {
+    QUIT,
+    RUNNING,
+    PAUSED,
+} emu_state;
+
+/* Reason emulation was stopped by the interpreter itself rather than the user */
+typedef enum {
+    NO_FAULT,
+    STACK_OVERFLOW,     // 2NNN with all 16 stack levels in use
+    STACK_UNDERFLOW,    // 00EE with an empty stack
+    PC_OUT_OF_RANGE,    // PC points past the last complete opcode in RAM
+} emu_fault;
+
+/* Behavior variants that differ between CHIP-8 interpreters; with none set, behavior
+   matches this interpreter's defaults. ROMs written for one variant can break on another */
+typedef enum {
+    QUIRK_SHIFT_VY      = 1 << 0,   // 8XY6/8XYE shift VY into VX (COSMAC VIP) instead of shifting VX in place
+    QUIRK_LOAD_STORE_I  = 1 << 1,   // FX55/FX65 leave I pointing past the last register
+    QUIRK_JUMP_VX       = 1 << 2,   // BXNN jumps to XNN + VX (CHIP-48/SUPER-CHIP) instead of NNN + V0
+    QUIRK_VF_RESET      = 1 << 3,   // 8XY1/8XY2/8XY3 clear VF
+    QUIRK_SPRITE_WRAP   = 1 << 4,   // Sprites wrap around the screen edges instead of being clipped
+    QUIRK_DISPLAY_WAIT  = 1 << 5,   // DXYN waits for the next frame, so at most one sprite is drawn per frame
+} quirk_flags;
+#define QUIRK_COUNT 6
+
+/* CHip-8 Object */
+typedef struct {
+    uint8_t ram[RAM_SIZE];  // CHIP-8 has access to up to 4kb of RAM
+    bool display [SCREEN_WIDTH * SCREEN_HEIGHT]; // Each pixel is either on (1) or off (0); 64x32 is the original CHIP-8 resolution
+    uint16_t stack[16];     // Used to store addresses of subroutines; Allows up to 16 levels of nested subroutines
+    int stack_size;         // Stack "pointer"
+    uint8_t V[16];          // V0 - VF data registers; VF is a flag register
+    uint16_t I;             // I register; Commonly used for storing memory addresses
+    uint8_t delay_timer;    // Decremented by 60Hz (60 times/sec) until 0
+    uint8_t sound_timer;    // Decremented by 60Hz until 0; Plays CHIP-8 beeping sound if non-zero
+    uint16_t PC;            // Program counter
+    bool keypad[16];        // Each key can be pressed (1) or not (0). See handle_input() for more
+    uint8_t wait_key;       // Key FX0A saw pressed; only valid while wait_key_pressed is set
+    bool wait_key_pressed;  // FX0A is waiting for wait_key to be released
+    emu_state state;        // Can be RUNNING, PAUSED, or STOPPED
+    emu_fault fault;        // Set alongside state = QUIT when the ROM does something invalid
+    uint32_t volume;        // How loud emulation audio is; defaults to 1500; min 0, max 3000
+    uint8_t audio_pattern[16]; // XO-CHIP 1-bit audio pattern loaded by F002; played instead of the square wave once set
+    uint8_t pitch;          // XO-CHIP pitch register set by FX3A; pattern plays at 4000 * 2^((pitch - 64) / 48) bits/sec
+    bool xo_audio;          // A pattern has been loaded with F002
+    uint8_t quirks;         // quirk_flags in effect
+    bool drew_this_frame;   // DXYN already ran this frame; used by QUIRK_DISPLAY_WAIT
+    bool display_dirty;     // Set by 00E0/DXYN; cleared by whoever redraws the display
+    uint32_t rng;           // CXNN random number state; per instance so runs are reproducible
+} chip8_t;
+
+void reset_chip8(chip8_t *chip8);
+bool load_rom(chip8_t *chip8, const uint8_t *rom, size_t rom_size);
+bool initialize_chip8(chip8_t *chip8, const char rom_name[]);
+uint16_t fetch_instruction(chip8_t *chip8);
+void execute_instruction(chip8_t *chip8);
+void tick_timers(chip8_t *chip8);
+void run_frame(chip8_t *chip8);
+const char *fault_name(emu_fault fault);
+const char *quirk_name(quirk_flags quirk);
+
+#endif
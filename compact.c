@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include <string.h>
+#include "compact.h"
+
+/* Bytes used by one packed instance, including its private RAM pages */
+size_t compact_size(const compact_chip8_t *compact) {
+    return sizeof(*compact) + (size_t)__builtin_popcount(compact->private_pages) * COMPACT_PAGE_SIZE;
+}
+
+/* Packs chip8 into reuse (or a new allocation if reuse is NULL), storing only RAM pages that
+   differ from shared_image; Returns the possibly moved instance, or NULL if allocation failed */
+compact_chip8_t *compact_pack(const chip8_t *chip8, const uint8_t shared_image[RAM_SIZE], compact_chip8_t *reuse) {
+    uint16_t private_pages = 0;
+
+    // Find which pages have been written since the ROM was loaded
+    for (uint8_t page = 0; page < COMPACT_PAGE_COUNT; page++) {
+        const size_t offset = page * COMPACT_PAGE_SIZE;
+        if (memcmp(&chip8->ram[offset], &shared_image[offset], COMPACT_PAGE_SIZE) != 0) {
+            private_pages |= 1 << page;
+        }
+    }
+
+    const size_t size = sizeof(compact_chip8_t) + (size_t)__builtin_popcount(private_pages) * COMPACT_PAGE_SIZE;
+    compact_chip8_t *compact = realloc(reuse, size);
+    if (compact == NULL) {
+        return NULL;
+    }
+
+    // Copy private pages in page order
+    compact->private_pages = private_pages;
+    uint8_t slot = 0;
+    for (uint8_t page = 0; page < COMPACT_PAGE_COUNT; page++) {
+        if (private_pages & (1 << page)) {
+            memcpy(compact->private_page_data[slot++], &chip8->ram[page * COMPACT_PAGE_SIZE], COMPACT_PAGE_SIZE);
+        }
+    }
+
+    // Bit-pack display and keypad
+    memset(compact->display, 0, sizeof(compact->display));
+    for (uint32_t i = 0; i < sizeof(chip8->display); i++) {
+        compact->display[i / 8] |= chip8->display[i] << (7 - (i % 8));
+    }
+    compact->keypad = 0;
+    for (uint8_t k = 0; k < sizeof(chip8->keypad); k++) {
+        compact->keypad |= chip8->keypad[k] << k;
+    }
+
+    memcpy(compact->stack, chip8->stack, sizeof(compact->stack));
+    memcpy(compact->V, chip8->V, sizeof(compact->V));
+    compact->I = chip8->I;
+    compact->PC = chip8->PC;
+    compact->volume = chip8->volume;
+    compact->delay_timer = chip8->delay_timer;
+    compact->sound_timer = chip8->sound_timer;
+    compact->stack_size = chip8->stack_size;
+    compact->wait_key = chip8->wait_key;
+    memcpy(compact->audio_pattern, chip8->audio_pattern, sizeof(compact->audio_pattern));
+    compact->pitch = chip8->pitch;
+    compact->quirks = chip8->quirks;
+    compact->rng = chip8->rng;
+    compact->flags = chip8->state | (chip8->fault << 2) | (chip8->wait_key_pressed << 4) | (chip8->xo_audio << 5) |
+        (chip8->drew_this_frame << 6) | (chip8->display_dirty << 7);
+
+    return compact;
+}
+
+/* Expands a packed instance back into a full chip8_t; shared_image must be the one it was packed against */
+void compact_unpack(chip8_t *chip8, const compact_chip8_t *compact, const uint8_t shared_image[RAM_SIZE]) {
+    // Shared pages come from the image, private pages from the instance
+    uint8_t slot = 0;
+    for (uint8_t page = 0; page < COMPACT_PAGE_COUNT; page++) {
+        const uint8_t *src = (compact->private_pages & (1 << page)) ?
+            compact->private_page_data[slot++] : &shared_image[page * COMPACT_PAGE_SIZE];
+        memcpy(&chip8->ram[page * COMPACT_PAGE_SIZE], src, COMPACT_PAGE_SIZE);
+    }
+
+    for (uint32_t i = 0; i < sizeof(chip8->display); i++) {
+        chip8->display[i] = (compact->display[i / 8] >> (7 - (i % 8))) & 1;
+    }
+    for (uint8_t k = 0; k < sizeof(chip8->keypad); k++) {
+        chip8->keypad[k] = (compact->keypad >> k) & 1;
+    }
+
+    memcpy(chip8->stack, compact->stack, sizeof(chip8->stack));
+    memcpy(chip8->V, compact->V, sizeof(chip8->V));
+    chip8->I = compact->I;
+    chip8->PC = compact->PC;
+    chip8->volume = compact->volume;
+    chip8->delay_timer = compact->delay_timer;
+    chip8->sound_timer = compact->sound_timer;
+    chip8->stack_size = compact->stack_size;
+    chip8->wait_key = compact->wait_key;
+    chip8->state = compact->flags & 0x3;
+    chip8->fault = (compact->flags >> 2) & 0x3;
+    chip8->wait_key_pressed = (compact->flags >> 4) & 1;
+    memcpy(chip8->audio_pattern, compact->audio_pattern, sizeof(chip8->audio_pattern));
+    chip8->pitch = compact->pitch;
+    chip8->xo_audio = (compact->flags >> 5) & 1;
+    chip8->drew_this_frame = (compact->flags >> 6) & 1;
+    chip8->display_dirty = (compact->flags >> 7) & 1;
+    chip8->quirks = compact->quirks;
+    chip8->rng = compact->rng;
+}
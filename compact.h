@@ -0,0 +1,46 @@
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chip8.h"
+
+/* Compact, parked form of a chip8_t for holding very large numbers of instances.
+
+   Display and keypad are bit-packed and the small fields are narrowed. RAM is
+   split into 256-byte pages; a page identical to the shared read-only image
+   (font + ROM as loaded) is not stored at all, and only pages the program has
+   written to get a private copy, kept in page order after the fixed fields.
+   Instances are unpacked into a full chip8_t to run and packed again after. */
+
+#define COMPACT_PAGE_SIZE 256
+#define COMPACT_PAGE_COUNT (RAM_SIZE / COMPACT_PAGE_SIZE)
+
+typedef struct {
+    uint8_t display[SCREEN_WIDTH * SCREEN_HEIGHT / 8]; // 1 bit per pixel, MSB is the leftmost pixel
+    uint16_t stack[16];
+    uint8_t V[16];
+    uint16_t I;
+    uint16_t PC;
+    uint16_t keypad;        // Bit N = key N pressed
+    uint16_t private_pages; // Bit N = RAM page N differs from the shared image and is stored below
+    uint32_t rng;
+    uint16_t volume;
+    uint8_t audio_pattern[16];
+    uint8_t pitch;
+    uint8_t quirks;
+    uint8_t delay_timer;
+    uint8_t sound_timer;
+    uint8_t stack_size;
+    uint8_t wait_key;
+    // emu_state in bits 0-1, emu_fault in bits 2-3, then one bit each for
+    // wait_key_pressed, xo_audio, drew_this_frame and display_dirty
+    uint8_t flags;
+    uint8_t private_page_data[][COMPACT_PAGE_SIZE];
+} compact_chip8_t;
+
+size_t compact_size(const compact_chip8_t *compact);
+compact_chip8_t *compact_pack(const chip8_t *chip8, const uint8_t shared_image[RAM_SIZE], compact_chip8_t *reuse);
+void compact_unpack(chip8_t *chip8, const compact_chip8_t *compact, const uint8_t shared_image[RAM_SIZE]);
+
+#endif
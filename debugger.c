@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debugger.h"
+
+static bool bit_set(const uint8_t bitmap[], uint16_t addr) {
+    addr &= RAM_SIZE - 1;
+    return bitmap[addr >> 3] & (1 << (addr & 7));
+}
+
+static void set_bit(uint8_t bitmap[], uint16_t addr, bool value) {
+    addr &= RAM_SIZE - 1;
+    if (value) {
+        bitmap[addr >> 3] |= 1 << (addr & 7);
+    } else {
+        bitmap[addr >> 3] &= ~(1 << (addr & 7));
+    }
+}
+
+/* True if addr has a plain breakpoint, no condition attached, or any attached condition currently holds */
+static bool conditions_hold(const debugger_t *debugger, const chip8_t *chip8, uint16_t addr) {
+    bool conditional = false;
+
+    if (bit_set(debugger->unconditional, addr)) {
+        return true;
+    }
+
+    for (uint8_t i = 0; i < debugger->condition_count; i++) {
+        const condition_t *cond = &debugger->conditions[i];
+        if (cond->addr != addr) {
+            continue;
+        }
+        conditional = true;
+
+        const uint16_t lhs = cond->reg == 16 ? chip8->I : chip8->V[cond->reg];
+        switch (cond->op) {
+            case COND_EQ: if (lhs == cond->value) return true; break;
+            case COND_NE: if (lhs != cond->value) return true; break;
+            case COND_LT: if (lhs <  cond->value) return true; break;
+            case COND_GT: if (lhs >  cond->value) return true; break;
+            case COND_LE: if (lhs <= cond->value) return true; break;
+            case COND_GE: if (lhs >= cond->value) return true; break;
+        }
+    }
+    return !conditional;
+}
+
+/* Finds the RAM range the opcode at PC is about to read or write; Returns false if it doesn't touch RAM via I */
+static bool memory_access(const chip8_t *chip8, uint16_t *start, uint16_t *length, bool *write) {
+    const uint16_t pc = chip8->PC & (RAM_SIZE - 1);
+    const uint16_t opcode = (chip8->ram[pc] << 8) | chip8->ram[(pc + 1) & (RAM_SIZE - 1)];
+    const uint8_t X = (opcode >> 8) & 0x000F;
+
+    *start = chip8->I;
+    if ((opcode & 0xF000) == 0xD000) {          // DXYN reads N sprite bytes
+        *length = opcode & 0x000F;
+        *write = false;
+        return true;
+    }
+    switch (opcode & 0xF0FF) {
+        case 0xF033: *length = 3;     *write = true;  return true; // FX33 writes 3 BCD digits
+        case 0xF055: *length = X + 1; *write = true;  return true; // FX55 writes V0-VX
+        case 0xF065: *length = X + 1; *write = false; return true; // FX65 reads V0-VX
+        case 0xF002: *length = 16;    *write = false; return opcode == 0xF002; // F002 reads the audio pattern
+        default: return false;
+    }
+}
+
+static void print_registers(const chip8_t *chip8) {
+    const uint16_t pc = chip8->PC & (RAM_SIZE - 1);
+
+    printf("PC=0x%03X [%02X%02X]  I=0x%03X  SP=%d  DT=%u  ST=%u\n", chip8->PC, chip8->ram[pc],
+        chip8->ram[(pc + 1) & (RAM_SIZE - 1)], chip8->I, chip8->stack_size, chip8->delay_timer, chip8->sound_timer);
+    for (uint8_t i = 0; i < 16; i++) {
+        printf("V%X=%02X%s", i, chip8->V[i], i == 7 || i == 15 ? "\n" : "  ");
+    }
+}
+
+/* Decides whether the instruction at PC should stop execution, and says why */
+bool debugger_slow_path(debugger_t *debugger, const chip8_t *chip8) {
+    const uint16_t pc = chip8->PC & (RAM_SIZE - 1);
+    uint16_t start, length;
+    bool write;
+
+    // Single step
+    if (debugger->trap_next && !debugger->step_over) {
+        debugger->trap_next = false;
+        return true;
+    }
+
+    // Step over: back in the caller at the same stack depth
+    if (debugger->step_over && pc == debugger->step_over_pc && chip8->stack_size == debugger->step_over_depth) {
+        debugger->trap_next = debugger->step_over = false;
+        return true;
+    }
+
+    if (bit_set(debugger->breakpoints, pc) && conditions_hold(debugger, chip8, pc)) {
+        debugger->trap_next = debugger->step_over = false;
+        printf("Breakpoint at 0x%03X\n", pc);
+        return true;
+    }
+
+    if (debugger->watch_count > 0 && memory_access(chip8, &start, &length, &write)) {
+        const uint8_t *bitmap = write ? debugger->write_watch : debugger->read_watch;
+        for (uint16_t i = 0; i < length; i++) {
+            if (bit_set(bitmap, start + i)) {
+                debugger->trap_next = debugger->step_over = false;
+                printf("Watchpoint: %s of 0x%03X by instruction at 0x%03X\n",
+                    write ? "write" : "read", (start + i) & (RAM_SIZE - 1), pc);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Parses "V0".."VF" or "I" into a condition register index (16 = I) */
+static bool parse_register(const char *name, uint8_t *reg) {
+    if ((name[0] == 'I' || name[0] == 'i') && name[1] == '\0') {
+        *reg = 16;
+        return true;
+    }
+    if ((name[0] == 'V' || name[0] == 'v') && name[1] != '\0' && name[2] == '\0') {
+        char *end;
+        *reg = strtoul(&name[1], &end, 16);
+        return *end == '\0';
+    }
+    return false;
+}
+
+static bool parse_op(const char *op, condition_op *out) {
+    const char *names[] = { "==", "!=", "<", ">", "<=", ">=" };
+
+    for (uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(op, names[i]) == 0) {
+            *out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Arms or clears a watch on [start, end] for reads and/or writes */
+static void set_watch(debugger_t *debugger, uint16_t start, uint16_t end, bool read, bool write, bool value) {
+    for (uint32_t addr = start; addr <= end && addr < RAM_SIZE; addr++) {
+        if (read && bit_set(debugger->read_watch, addr) != value) {
+            set_bit(debugger->read_watch, addr, value);
+            debugger->watch_count += value ? 1 : -1;
+        }
+        if (write && bit_set(debugger->write_watch, addr) != value) {
+            set_bit(debugger->write_watch, addr, value);
+            debugger->watch_count += value ? 1 : -1;
+        }
+    }
+}
+
+static void print_help(void) {
+    printf("Debugger commands (all numbers are hex):\n"
+        "  c                        continue\n"
+        "  s                        step one instruction\n"
+        "  n                        step over (runs a 2NNN subroutine to completion)\n"
+        "  b ADDR [if REG OP VAL]   break at ADDR; REG is V0-VF or I, OP is == != < > <= >=\n"
+        "  d ADDR                   delete breakpoint(s) at ADDR\n"
+        "  w r|w|rw START [END]     watch reads/writes of RAM by DXYN/FX33/FX55/FX65/F002\n"
+        "  u START [END]            remove watches from RAM range\n"
+        "  l                        list breakpoints\n"
+        "  r                        show registers\n"
+        "  x ADDR [LEN]             dump memory\n"
+        "  q                        quit emulator\n");
+}
+
+/* Interactive console; returns once the user continues or steps. Blocks emulation meanwhile */
+void debugger_prompt(debugger_t *debugger, chip8_t *chip8) {
+    char line[128], arg1[16], arg2[16], arg3[16];
+    unsigned int a, b;
+
+    print_registers(chip8);
+
+    while (true) {
+        printf("(chip8) ");
+        fflush(stdout);
+        if (fgets(line, sizeof(line), stdin) == NULL) {
+            debugger->active = false; // No console; detach and let the ROM run
+            return;
+        }
+
+        switch (line[0]) {
+            case 'c':
+                return;
+
+            case 's':
+                debugger->trap_next = true;
+                return;
+
+            case 'n':
+                {
+                const uint16_t pc = chip8->PC & (RAM_SIZE - 1);
+                debugger->trap_next = true;
+                if ((chip8->ram[pc] >> 4) == 0x2) { // 2NNN: stop on return to the next instruction
+                    debugger->step_over = true;
+                    debugger->step_over_pc = pc + 2;
+                    debugger->step_over_depth = chip8->stack_size;
+                }
+                return;
+                }
+
+            case 'b':
+                {
+                const int fields = sscanf(line, "b %x if %15s %15s %x", &a, arg1, arg2, &b);
+                uint8_t reg;
+                condition_op op;
+
+                if (fields < 1 || fields == 2 || fields == 3 || a >= RAM_SIZE) { // Incomplete conditions are errors
+                    printf("Usage: b ADDR [if REG OP VAL]\n");
+                    break;
+                }
+                if (fields == 4) {
+                    if (!parse_register(arg1, &reg) || reg > 16 || !parse_op(arg2, &op)) {
+                        printf("Condition must look like: V3 == 1F\n");
+                        break;
+                    }
+                    if (debugger->condition_count == MAX_CONDITIONS) {
+                        printf("Too many conditional breakpoints\n");
+                        break;
+                    }
+                    debugger->conditions[debugger->condition_count++] = (condition_t){a, reg, op, b};
+                } else {
+                    set_bit(debugger->unconditional, a, true); // Always stops, whatever conditions are also attached
+                }
+                set_bit(debugger->breakpoints, a, true);
+                break;
+                }
+
+            case 'd':
+                if (sscanf(line, "d %x", &a) != 1) {
+                    printf("Usage: d ADDR\n");
+                    break;
+                }
+                set_bit(debugger->breakpoints, a, false);
+                set_bit(debugger->unconditional, a, false);
+                for (uint8_t i = 0; i < debugger->condition_count; ) {
+                    if (debugger->conditions[i].addr == a) {
+                        debugger->conditions[i] = debugger->conditions[--debugger->condition_count];
+                    } else {
+                        i++;
+                    }
+                }
+                break;
+
+            case 'w':
+                {
+                const int fields = sscanf(line, "w %15s %x %x", arg1, &a, &b);
+                if (fields < 2 || (strcmp(arg1, "r") != 0 && strcmp(arg1, "w") != 0 && strcmp(arg1, "rw") != 0)) {
+                    printf("Usage: w r|w|rw START [END]\n");
+                    break;
+                }
+                set_watch(debugger, a, fields == 3 ? b : a, strchr(arg1, 'r') != NULL, strchr(arg1, 'w') != NULL, true);
+                break;
+                }
+
+            case 'u':
+                {
+                const int fields = sscanf(line, "u %x %x", &a, &b);
+                if (fields < 1) {
+                    printf("Usage: u START [END]\n");
+                    break;
+                }
+                set_watch(debugger, a, fields == 2 ? b : a, true, true, false);
+                break;
+                }
+
+            case 'l':
+                for (uint16_t addr = 0; addr < RAM_SIZE; addr++) {
+                    if (!bit_set(debugger->breakpoints, addr)) {
+                        continue;
+                    }
+                    printf("0x%03X", addr);
+                    for (uint8_t i = 0; i < debugger->condition_count; i++) {
+                        const condition_t *cond = &debugger->conditions[i];
+                        const char *ops[] = { "==", "!=", "<", ">", "<=", ">=" };
+                        if (cond->addr == addr) {
+                            if (cond->reg == 16) {
+                                snprintf(arg3, sizeof(arg3), "I");
+                            } else {
+                                snprintf(arg3, sizeof(arg3), "V%X", cond->reg);
+                            }
+                            printf(" [if %s %s %X]", arg3, ops[cond->op], cond->value);
+                        }
+                    }
+                    printf(bit_set(debugger->unconditional, addr) ? " [always]\n" : "\n");
+                }
+                printf("%u watched addresses\n", debugger->watch_count);
+                break;
+
+            case 'r':
+                print_registers(chip8);
+                break;
+
+            case 'x':
+                {
+                const int fields = sscanf(line, "x %x %x", &a, &b);
+                if (fields < 1) {
+                    printf("Usage: x ADDR [LEN]\n");
+                    break;
+                }
+                const uint32_t length = fields < 2 ? 16 : b > RAM_SIZE ? RAM_SIZE : b; // All of RAM at most
+                for (uint32_t i = 0; i < length; i++) {
+                    if (i % 16 == 0) {
+                        printf("%s%03X:", i ? "\n" : "", (a + i) & (RAM_SIZE - 1));
+                    }
+                    printf(" %02X", chip8->ram[(a + i) & (RAM_SIZE - 1)]);
+                }
+                printf("\n");
+                break;
+                }
+
+            case 'q':
+                chip8->state = QUIT;
+                return;
+
+            default:
+                print_help();
+                break;
+        }
+    }
+}
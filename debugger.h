@@ -0,0 +1,61 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "chip8.h"
+
+#define MAX_CONDITIONS 32
+
+/* Comparison used by a conditional breakpoint */
+typedef enum {
+    COND_EQ,
+    COND_NE,
+    COND_LT,
+    COND_GT,
+    COND_LE,
+    COND_GE,
+} condition_op;
+
+/* Breakpoint at addr that only fires when V[reg] (or I, if reg is 16) compares true against value */
+typedef struct {
+    uint16_t addr;
+    uint8_t reg;
+    condition_op op;
+    uint16_t value;
+} condition_t;
+
+/* Interactive debugger state. Breakpoints and watchpoints are per-address bitmaps,
+   so the check before each instruction is a single bit test unless something is armed there */
+typedef struct {
+    bool active;                            // Checks run before every instruction; set by --debugger or F5
+    bool trap_next;                         // Stepping or stepping over: always take the slow path
+    bool step_over;                         // Stop once PC reaches step_over_pc at step_over_depth
+    uint16_t step_over_pc;
+    int step_over_depth;
+    uint8_t breakpoints[RAM_SIZE / 8];      // Bit per address: break when PC gets here (subject to conditions)
+    uint8_t unconditional[RAM_SIZE / 8];    // Bit per address: a plain "b ADDR" was set, so conditions don't matter
+    uint8_t read_watch[RAM_SIZE / 8];       // Bit per address: break before DXYN/FX65/F002 read it
+    uint8_t write_watch[RAM_SIZE / 8];      // Bit per address: break before FX33/FX55 write it
+    uint32_t watch_count;                   // Armed watch addresses; 0 skips watch decoding entirely
+    condition_t conditions[MAX_CONDITIONS];
+    uint8_t condition_count;
+} debugger_t;
+
+bool debugger_slow_path(debugger_t *debugger, const chip8_t *chip8);
+void debugger_prompt(debugger_t *debugger, chip8_t *chip8);
+
+/* Returns true if execution should stop before the instruction at PC. Only touches the
+   slow path when PC has a breakpoint bit, a step is pending, or a watched memory opcode is next */
+static inline bool debugger_check(debugger_t *debugger, const chip8_t *chip8) {
+    const uint16_t pc = chip8->PC & (RAM_SIZE - 1);
+    const uint8_t high_nibble = chip8->ram[pc] >> 4;
+
+    if (!debugger->trap_next && !(debugger->breakpoints[pc >> 3] & (1 << (pc & 7))) &&
+        (debugger->watch_count == 0 || (high_nibble != 0xD && high_nibble != 0xF))) {
+        return false;
+    }
+    return debugger_slow_path(debugger, chip8);
+}
+
+#endif
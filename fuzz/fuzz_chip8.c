@@ -0,0 +1,63 @@
+/* libFuzzer target for the CHIP-8 core (chip8.c).
+
+   Input layout: <ROM bytes> [ "KEYS" <quirks> <keypad stream> ]
+   Everything before the first "KEYS" marker is loaded at 0x200. The byte
+   after it is the quirk_flags bitmask to run with. Each pair of bytes after
+   that is a 16-bit keypad bitmask (bit N = key N held) for one frame; the
+   last mask is held once the stream runs out. Plain ROM files contain no
+   marker and run with no quirks, so TEST_ROMS can be used as a seed corpus as-is. */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "../chip8.h"
+
+#define FRAMES_PER_INPUT 32
+static const uint8_t keys_marker[] = { 'K', 'E', 'Y', 'S' };
+
+static chip8_t pristine; // Power-on state; copied over the working state each run instead of re-initializing
+static chip8_t chip8;
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    reset_chip8(&pristine);
+    return 0;
+}
+
+/* Returns offset of the first "KEYS" marker, or size if there is none */
+static size_t find_marker(const uint8_t *data, size_t size) {
+    for (size_t i = 0; i + sizeof(keys_marker) <= size; i++) {
+        if (memcmp(&data[i], keys_marker, sizeof(keys_marker)) == 0) {
+            return i;
+        }
+    }
+    return size;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const size_t rom_size = find_marker(data, size);
+    const size_t options = rom_size + sizeof(keys_marker); // Offset of the quirks byte, if there is one
+    const uint8_t *keys = data + options + 1;
+    const size_t key_frames = options < size ? (size - options - 1) / 2 : 0;
+    uint16_t mask = 0;
+
+    memcpy(&chip8, &pristine, sizeof(chip8));
+    if (!load_rom(&chip8, data, rom_size)) {
+        return 0;
+    }
+    if (options < size) {
+        chip8.quirks = data[options] & ((1 << QUIRK_COUNT) - 1);
+    }
+
+    for (size_t frame = 0; frame < FRAMES_PER_INPUT && chip8.state != QUIT; frame++) {
+        if (frame < key_frames) {
+            mask = keys[frame * 2] | (keys[frame * 2 + 1] << 8);
+        }
+        for (uint8_t k = 0; k < sizeof(chip8.keypad); k++) {
+            chip8.keypad[k] = (mask >> k) & 1;
+        }
+        run_frame(&chip8);
+    }
+
+    return 0;
+}
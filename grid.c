@@ -0,0 +1,242 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <SDL.h>
+#include "chip8.h"
+#include "grid.h"
+#include "keymap.h"
+
+#define FOREGROUND 0xFF8B7F94   // Same colors as update_screen(), as ARGB8888
+#define BACKGROUND 0xFF16091F
+#define FAULTED    0xFFB03A48   // Foreground for instances stopped by a fault
+#define FOCUS      0xFFFFD600
+
+/* All instances in the grid and the shared atlas they are composited into */
+typedef struct {
+    chip8_t *instances;
+    const char **names;
+    uint32_t count;
+    uint32_t columns, rows;
+    uint32_t scale;             // Window pixels per CHIP-8 pixel
+    uint32_t focus;             // Instance that receives keypad input
+    uint32_t *atlas;            // CPU copy of the texture; columns * 64 by rows * 32 ARGB pixels
+    SDL_Texture *texture;
+} grid_t;
+
+/* Redraws one instance's tile into the CPU atlas */
+static void draw_tile(grid_t *grid, uint32_t idx) {
+    const chip8_t *chip8 = &grid->instances[idx];
+    const uint32_t pitch = grid->columns * SCREEN_WIDTH;
+    const uint32_t foreground = chip8->fault != NO_FAULT ? FAULTED : FOREGROUND;
+    uint32_t *tile = &grid->atlas[(idx / grid->columns) * SCREEN_HEIGHT * pitch + (idx % grid->columns) * SCREEN_WIDTH];
+
+    for (uint32_t y = 0; y < SCREEN_HEIGHT; y++) {
+        for (uint32_t x = 0; x < SCREEN_WIDTH; x++) {
+            tile[y * pitch + x] = chip8->display[y * SCREEN_WIDTH + x] ? foreground : BACKGROUND;
+        }
+    }
+}
+
+/* Redraws dirty tiles and uploads them with one SDL_UpdateTexture covering the rows of tiles that changed */
+static void upload_dirty_tiles(grid_t *grid) {
+    const uint32_t pitch = grid->columns * SCREEN_WIDTH;
+    uint32_t first_row = grid->rows, last_row = 0;
+
+    for (uint32_t i = 0; i < grid->count; i++) {
+        chip8_t *chip8 = &grid->instances[i];
+        if (!chip8->display_dirty) {
+            continue;
+        }
+        chip8->display_dirty = false;
+        draw_tile(grid, i);
+
+        const uint32_t row = i / grid->columns;
+        first_row = row < first_row ? row : first_row;
+        last_row = row > last_row ? row : last_row;
+    }
+
+    if (first_row > last_row) {
+        return; // Nothing changed this frame
+    }
+    const SDL_Rect rect = {0, first_row * SCREEN_HEIGHT, pitch, (last_row - first_row + 1) * SCREEN_HEIGHT};
+    SDL_UpdateTexture(grid->texture, &rect, &grid->atlas[first_row * SCREEN_HEIGHT * pitch], pitch * sizeof(uint32_t));
+}
+
+/* Moves keypad focus, releasing any keys still held on the instance losing it */
+static void set_focus(grid_t *grid, SDL_Window *window, uint32_t focus) {
+    char title[256];
+
+    memset(grid->instances[grid->focus].keypad, false, sizeof(grid->instances[grid->focus].keypad));
+    grid->focus = focus;
+    snprintf(title, sizeof(title), "CHIP-8 Emulator - [%u] %s", focus, grid->names[focus]);
+    SDL_SetWindowTitle(window, title);
+}
+
+/* Handles window input for the grid; keypad keys go to the focused instance only.
+   Returns false once the user quits */
+static bool handle_grid_input(grid_t *grid, SDL_Window *window, bool *paused) {
+    SDL_Event event;
+
+    while (SDL_PollEvent(&event)) {
+        switch (event.type) {
+            case SDL_QUIT:
+                return false;
+
+            case SDL_MOUSEBUTTONDOWN:
+                {
+                // Click a tile to focus it
+                const uint32_t column = event.button.x / (SCREEN_WIDTH * grid->scale);
+                const uint32_t row = event.button.y / (SCREEN_HEIGHT * grid->scale);
+                if (column < grid->columns && row * grid->columns + column < grid->count) {
+                    set_focus(grid, window, row * grid->columns + column);
+                }
+                break;
+                }
+
+            case SDL_KEYDOWN:
+                switch (event.key.keysym.sym) {
+                    case SDLK_ESCAPE:
+                        return false;
+
+                    case SDLK_SPACE:
+                        *paused = !*paused;
+                        printf(*paused ? "PAUSED\n" : "RESUMED\n");
+                        break;
+
+                    case SDLK_TAB:
+                        set_focus(grid, window, (grid->focus + 1) % grid->count);
+                        break;
+
+                    default:
+                        if (keypad_index(event.key.keysym.sym) >= 0) {
+                            grid->instances[grid->focus].keypad[keypad_index(event.key.keysym.sym)] = true;
+                        }
+                        break;
+                }
+                break;
+
+            case SDL_KEYUP:
+                if (keypad_index(event.key.keysym.sym) >= 0) {
+                    grid->instances[grid->focus].keypad[keypad_index(event.key.keysym.sym)] = false;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+/* Runs count instances in one window, cycling through rom_names to fill them. Audio is not played in grid mode */
+bool run_grid(uint32_t count, char *rom_names[], uint32_t rom_count, uint8_t quirks) {
+    static chip8_t instances[GRID_MAX_INSTANCES];
+    static const char *names[GRID_MAX_INSTANCES];
+    grid_t grid = { .instances = instances, .names = names, .count = count };
+    SDL_Window *window = NULL;
+    SDL_Renderer *renderer = NULL;
+    bool paused = false, ok = false;
+
+    if (count == 0 || count > GRID_MAX_INSTANCES || rom_count == 0) {
+        printf("Grid mode runs 1 to %d instances\n", GRID_MAX_INSTANCES);
+        return false;
+    }
+
+    // Load every ROM before starting SDL
+    for (uint32_t i = 0; i < count; i++) {
+        names[i] = rom_names[i % rom_count];
+        if (!initialize_chip8(&instances[i], names[i])) {
+            return false;
+        }
+        instances[i].rng = (time(NULL) + i) | 1;
+        instances[i].quirks = quirks;
+        instances[i].display_dirty = true; // Draw every tile once
+    }
+
+    // Near-square layout, scaled to fit a 1280x640 window
+    grid.columns = ceil(sqrt(count));
+    grid.rows = (count + grid.columns - 1) / grid.columns;
+    grid.scale = fmin(1280 / (grid.columns * SCREEN_WIDTH), 640 / (grid.rows * SCREEN_HEIGHT));
+    grid.scale = grid.scale < 1 ? 1 : grid.scale;
+    grid.atlas = calloc(grid.columns * SCREEN_WIDTH * grid.rows * SCREEN_HEIGHT, sizeof(uint32_t));
+    if (grid.atlas == NULL) {
+        printf("Could not allocate grid atlas\n");
+        return false;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        printf("SDL subsytsems failed to initialize. Error: %s\n", SDL_GetError());
+        goto done;
+    }
+    window = SDL_CreateWindow("CHIP-8 Emulator", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        grid.columns * SCREEN_WIDTH * grid.scale, grid.rows * SCREEN_HEIGHT * grid.scale, 0);
+    if (window == NULL) {
+        printf("SDL window failed to initialize. Error: %s\n", SDL_GetError());
+        goto done;
+    }
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (renderer == NULL) {
+        printf("SDL renderer failed to initialize. Error: %s\n", SDL_GetError());
+        goto done;
+    }
+    grid.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+        grid.columns * SCREEN_WIDTH, grid.rows * SCREEN_HEIGHT);
+    if (grid.texture == NULL) {
+        printf("SDL texture failed to initialize. Error: %s\n", SDL_GetError());
+        goto done;
+    }
+    set_focus(&grid, window, 0);
+
+    while (handle_grid_input(&grid, window, &paused)) {
+        const uint64_t start = SDL_GetPerformanceCounter();
+
+        if (!paused) {
+            for (uint32_t i = 0; i < count; i++) {
+                const emu_fault fault = instances[i].fault;
+                run_frame(&instances[i]);
+                if (instances[i].fault != fault) {
+                    instances[i].display_dirty = true; // Redraw once in the fault color; it won't draw again
+                }
+            }
+        }
+
+        upload_dirty_tiles(&grid);
+        SDL_RenderCopy(renderer, grid.texture, NULL, NULL);
+
+        // Outline the focused tile
+        const SDL_Rect focus = {
+            (grid.focus % grid.columns) * SCREEN_WIDTH * grid.scale, (grid.focus / grid.columns) * SCREEN_HEIGHT * grid.scale,
+            SCREEN_WIDTH * grid.scale, SCREEN_HEIGHT * grid.scale
+        };
+        SDL_SetRenderDrawColor(renderer, (FOCUS >> 16) & 0xFF, (FOCUS >> 8) & 0xFF, FOCUS & 0xFF, SDL_ALPHA_OPAQUE);
+        SDL_RenderDrawRect(renderer, &focus);
+        SDL_RenderPresent(renderer);
+
+        // Delay for approximately 60Hz/60fps (16.67ms) or continue if the frame took longer
+        const double elapsed_time = (double)((SDL_GetPerformanceCounter() - start) * 1000) / SDL_GetPerformanceFrequency();
+        SDL_Delay(16.67 > elapsed_time ? 16.67 - elapsed_time : 0);
+    }
+    ok = true;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (instances[i].fault != NO_FAULT) {
+            printf("[%u] %s stopped at PC 0x%04X: %s\n", i, names[i], instances[i].PC, fault_name(instances[i].fault));
+        }
+    }
+
+done:
+    if (grid.texture != NULL) {
+        SDL_DestroyTexture(grid.texture);
+    }
+    if (renderer != NULL) {
+        SDL_DestroyRenderer(renderer);
+    }
+    if (window != NULL) {
+        SDL_DestroyWindow(window);
+    }
+    SDL_Quit();
+    free(grid.atlas);
+    return ok;
+}
@@ -0,0 +1,11 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GRID_MAX_INSTANCES 64
+
+bool run_grid(uint32_t count, char *rom_names[], uint32_t rom_count, uint8_t quirks);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <SDL.h>
+
+/* Returns the CHIP-8 keypad index for a QWERTY key, or -1 if it isn't a keypad key
+   Original CHIP-8 Keypad -> QWERTY
+   1 2 3 C                   1 2 3 4
+   4 5 6 D                   Q W E R
+   7 8 9 E                   A S D F
+   A 0 B F                   Z X C V */
+static inline int keypad_index(SDL_Keycode key) {
+    switch (key) {
+        // 1 2 3 C -> 1 2 3 4
+        case SDLK_1: return 0x1;
+        case SDLK_2: return 0x2;
+        case SDLK_3: return 0x3;
+        case SDLK_4: return 0xC;
+        // 4 5 6 D -> Q W E R
+        case SDLK_q: return 0x4;
+        case SDLK_w: return 0x5;
+        case SDLK_e: return 0x6;
+        case SDLK_r: return 0xD;
+        // 7 8 9 E -> A S D F
+        case SDLK_a: return 0x7;
+        case SDLK_s: return 0x8;
+        case SDLK_d: return 0x9;
+        case SDLK_f: return 0xE;
+        // A 0 B F -> Z X C V
+        case SDLK_z: return 0xA;
+        case SDLK_x: return 0x0;
+        case SDLK_c: return 0xB;
+        case SDLK_v: return 0xF;
+
+        default: return -1;
+    }
+}
+
+#endif
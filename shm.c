@@ -0,0 +1,214 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shm.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+_Static_assert(sizeof(shm_header_t) == 64, "shm_header_t must stay one cache line");
+_Static_assert(offsetof(shm_env_t, chip8) % 64 == 0, "chip8 must start on its own cache line, away from the sequence counters");
+
+/* Total bytes needed for a region holding env_count environments */
+size_t shm_region_size(uint32_t env_count) {
+    return sizeof(shm_header_t) + (size_t)env_count * sizeof(shm_env_t);
+}
+
+/* Returns the environment slot at idx */
+shm_env_t *shm_env(shm_header_t *header, uint32_t idx) {
+    return (shm_env_t *)(header + 1) + idx;
+}
+
+#ifndef _WIN32
+
+static volatile sig_atomic_t interrupted; // Set by SIGINT/SIGTERM so the server still removes its region
+
+static void handle_stop_signal(int signal) {
+    (void)signal;
+    interrupted = 1;
+}
+
+/* Applies the requested keypad state and steps one environment, exactly as
+   the main loop would minus SDL: keypad from input, instruction batch, timer tick */
+static void step_env(shm_env_t *env, const chip8_t *initial) {
+    if (env->reset) {
+        memcpy(&env->chip8, initial, sizeof(env->chip8));
+        env->frame_count = 0;
+    }
+
+    for (uint8_t k = 0; k < sizeof(env->chip8.keypad); k++) {
+        env->chip8.keypad[k] = (env->action >> k) & 1;
+    }
+
+    for (uint16_t f = 0; f < env->frames; f++) {
+        run_frame(&env->chip8);
+        env->frame_count++;
+    }
+}
+
+/* Creates the shared region, loads the ROM into every slot and serves step requests until a client sets
+   shutdown or the server gets SIGINT/SIGTERM; the region is unlinked either way */
+bool run_shm_server(const char name[], uint32_t env_count, const char rom_name[]) {
+    chip8_t initial;
+
+    if (env_count == 0) {
+        printf("Shared memory mode needs at least one environment\n");
+        return false;
+    }
+
+    if (!initialize_chip8(&initial, rom_name)) {
+        return false;
+    }
+
+    // Create and map the region; pages are zero-filled so every slot starts idle
+    const size_t size = shm_region_size(env_count);
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        return false;
+    }
+    if (ftruncate(fd, size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    shm_header_t *header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < env_count; i++) {
+        memcpy(&shm_env(header, i)->chip8, &initial, sizeof(initial));
+    }
+    header->version = SHM_VERSION;
+    header->env_count = env_count;
+    header->env_size = sizeof(shm_env_t);
+    atomic_thread_fence(memory_order_release);
+    header->magic = SHM_MAGIC;
+
+    struct sigaction action = {0};
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Serving %u environments of %s in shared memory %s (%zu bytes)\n", env_count, rom_name, name, size);
+
+    // Poll every slot for new requests; back off only when a full pass found nothing to do
+    while (!interrupted && !atomic_load_explicit(&header->shutdown, memory_order_acquire)) {
+        bool busy = false;
+
+        for (uint32_t i = 0; i < env_count; i++) {
+            shm_env_t *env = shm_env(header, i);
+            const uint32_t seq = atomic_load_explicit(&env->request_seq, memory_order_acquire);
+
+            if (seq != atomic_load_explicit(&env->done_seq, memory_order_relaxed)) {
+                step_env(env, &initial);
+                atomic_store_explicit(&env->done_seq, seq, memory_order_release);
+                busy = true;
+            }
+        }
+
+        if (!busy) {
+            sched_yield();
+        }
+    }
+
+    munmap(header, size);
+    shm_unlink(name);
+    return true;
+}
+
+/* Maps an existing region created by run_shm_server; Returns NULL if it is missing or incompatible */
+shm_header_t *shm_attach(const char name[]) {
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    // Map just the header first to learn how many slots follow it
+    shm_header_t *header = mmap(NULL, sizeof(shm_header_t), PROT_READ, MAP_SHARED, fd, 0);
+    if (header == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    const bool valid = header->magic == SHM_MAGIC && header->version == SHM_VERSION &&
+        header->env_size == sizeof(shm_env_t);
+    const uint32_t env_count = header->env_count;
+    munmap(header, sizeof(shm_header_t));
+    if (!valid) {
+        close(fd);
+        return NULL;
+    }
+
+    header = mmap(NULL, shm_region_size(env_count), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return header == MAP_FAILED ? NULL : header;
+}
+
+/* Unmaps a region mapped with shm_attach */
+void shm_detach(shm_header_t *header) {
+    munmap(header, shm_region_size(header->env_count));
+}
+
+/* Submits a step request on an idle slot; Returns the sequence number to pass to shm_wait */
+uint32_t shm_submit(shm_env_t *env, uint16_t action, uint16_t frames, bool reset) {
+    const uint32_t seq = atomic_load_explicit(&env->request_seq, memory_order_relaxed) + 1;
+
+    env->action = action;
+    env->frames = frames;
+    env->reset = reset;
+    atomic_store_explicit(&env->request_seq, seq, memory_order_release);
+    return seq;
+}
+
+/* Spins until the server has finished request seq; slot->chip8 is then safe to read */
+void shm_wait(shm_env_t *env, uint32_t seq) {
+    while (atomic_load_explicit(&env->done_seq, memory_order_acquire) != seq) {
+        sched_yield();
+    }
+}
+
+#else
+
+bool run_shm_server(const char name[], uint32_t env_count, const char rom_name[]) {
+    (void)name;
+    (void)env_count;
+    (void)rom_name;
+    printf("Shared memory mode is only available on POSIX systems\n");
+    return false;
+}
+
+shm_header_t *shm_attach(const char name[]) {
+    (void)name;
+    return NULL;
+}
+
+void shm_detach(shm_header_t *header) {
+    (void)header;
+}
+
+uint32_t shm_submit(shm_env_t *env, uint16_t action, uint16_t frames, bool reset) {
+    (void)env;
+    (void)action;
+    (void)frames;
+    (void)reset;
+    return 0;
+}
+
+void shm_wait(shm_env_t *env, uint32_t seq) {
+    (void)env;
+    (void)seq;
+}
+
+#endif
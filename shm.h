@@ -0,0 +1,55 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "chip8.h"
+
+/* Shared-memory environment interface for driving many headless CHIP-8
+   instances from another process.
+
+   The region is a shm_header_t followed by env_count shm_env_t slots. Each
+   slot holds the emulator state itself, so observations (display, V, I, PC,
+   timers) are read straight out of slot->chip8 with no copying.
+
+   Per-slot handshake (one client, one server per slot):
+   1. Client waits until done_seq == request_seq (slot idle)
+   2. Client writes action/frames/reset, then stores request_seq + 1 (release)
+   3. Server steps the slot and stores done_seq = request_seq (release)
+   4. Client spins until done_seq (acquire) reaches its request, then reads chip8 */
+
+#define SHM_MAGIC 0x53384843    // "CH8S"
+#define SHM_VERSION 2
+
+typedef struct {
+    uint32_t magic;                 // SHM_MAGIC once the server has finished setting up the region
+    uint32_t version;               // SHM_VERSION; bumped whenever this layout changes
+    uint32_t env_count;             // Number of shm_env_t slots after the header
+    uint32_t env_size;              // sizeof(shm_env_t), for clients not written in C
+    _Atomic uint32_t shutdown;      // Set non-zero by a client to stop the server
+    uint8_t padding[44];            // Keeps slots cache-line aligned
+} shm_header_t;
+
+typedef struct {
+    _Atomic uint32_t request_seq;   // Bumped by the client to submit a step
+    _Atomic uint32_t done_seq;      // Caught up to request_seq by the server once the step is done
+    uint16_t action;                // Keypad bitmask held for every stepped frame; bit N = key N
+    uint16_t frames;                // Number of 60Hz frames to step for this request
+    uint8_t reset;                  // Restore the freshly loaded ROM before stepping
+    uint8_t padding[3];
+    uint32_t frame_count;           // Frames stepped since the last reset
+    uint8_t padding2[44];           // Keeps chip8 on its own cache lines
+    chip8_t chip8;                  // Emulator state; doubles as the observation
+} __attribute__((aligned(64))) shm_env_t;
+
+size_t shm_region_size(uint32_t env_count);
+shm_env_t *shm_env(shm_header_t *header, uint32_t idx);
+bool run_shm_server(const char name[], uint32_t env_count, const char rom_name[]);
+
+shm_header_t *shm_attach(const char name[]);
+void shm_detach(shm_header_t *header);
+uint32_t shm_submit(shm_env_t *env, uint16_t action, uint16_t frames, bool reset);
+void shm_wait(shm_env_t *env, uint32_t seq);
+
+#endif
@@ -0,0 +1,219 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "telemetry.h"
+
+#define OVERLAY_SCALE 3         // Screen pixels per overlay font pixel
+#define OVERLAY_LINE_CHARS 56
+#define OVERLAY_LINES 4
+
+/* Audio callbacks run on SDL's audio thread, so they only touch these */
+static _Atomic uint32_t audio_late_callbacks;
+static uint64_t last_audio_callback;
+
+/* 3x5 overlay font; each row is 3 bits, MSB on the left */
+static const struct {
+    char c;
+    uint8_t rows[5];
+} glyphs[] = {
+    {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}}, {'3', {7, 1, 7, 1, 7}},
+    {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}}, {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 2, 4, 4}},
+    {'8', {7, 5, 7, 5, 7}}, {'9', {7, 5, 7, 1, 7}}, {'.', {0, 0, 0, 0, 2}}, {'-', {0, 0, 7, 0, 0}}, {'A', {2, 5, 7, 5, 5}},
+    {'D', {6, 5, 5, 5, 6}}, {'E', {7, 4, 6, 4, 7}}, {'F', {7, 4, 6, 4, 4}}, {'I', {7, 2, 2, 2, 7}},
+    {'L', {4, 4, 4, 4, 7}}, {'M', {5, 7, 7, 5, 5}}, {'N', {6, 5, 5, 5, 5}}, {'O', {7, 5, 5, 5, 7}},
+    {'P', {7, 5, 7, 4, 4}}, {'R', {6, 5, 6, 5, 5}}, {'S', {7, 4, 7, 1, 7}}, {'T', {7, 2, 2, 2, 2}},
+    {'U', {5, 5, 5, 5, 7}}, {'V', {5, 5, 5, 5, 2}}, {'X', {5, 5, 2, 5, 5}},
+};
+
+/* Opens the CSV log if a path was given and starts the first summary window */
+bool telemetry_init(telemetry_t *telemetry, const char csv_path[]) {
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->frequency = SDL_GetPerformanceFrequency();
+    telemetry->summary_start = SDL_GetPerformanceCounter();
+
+    if (csv_path != NULL) {
+        telemetry->csv = fopen(csv_path, "w");
+        if (telemetry->csv == NULL) {
+            printf("Could not open telemetry file %s\n", csv_path);
+            return false;
+        }
+        fprintf(telemetry->csv, "frame,frame_ms,input_ms,execute_ms,sleep_ms,requested_sleep_ms,"
+            "run_ahead_ms,render_ms,timers_ms,instructions,audio_late_callbacks\n");
+    }
+    return true;
+}
+
+/* Marks the start of a frame and its first stage */
+void telemetry_begin_frame(telemetry_t *telemetry) {
+    frame_record_t *record = &telemetry->frames[telemetry->frame_count & (TELEMETRY_FRAMES - 1)];
+
+    memset(record, 0, sizeof(*record));
+    telemetry->frame_start = SDL_GetPerformanceCounter();
+    telemetry->stage_start = telemetry->frame_start;
+}
+
+/* Records the time since the previous stage ended (or the frame began) against stage */
+void telemetry_end_stage(telemetry_t *telemetry, telemetry_stage stage) {
+    const uint64_t now = SDL_GetPerformanceCounter();
+
+    telemetry->frames[telemetry->frame_count & (TELEMETRY_FRAMES - 1)].stage_ticks[stage] = now - telemetry->stage_start;
+    telemetry->stage_start = now;
+}
+
+/* Records how long the main loop asked SDL_Delay to sleep this frame */
+void telemetry_requested_sleep(telemetry_t *telemetry, uint32_t ms) {
+    telemetry->frames[telemetry->frame_count & (TELEMETRY_FRAMES - 1)].requested_sleep_ticks =
+        ms * telemetry->frequency / 1000;
+}
+
+static int compare_ticks(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Recomputes rates and averages over the frames since the summary window began, and
+   percentiles over the whole ring so that p95/p99 are not just the top one or two samples */
+static void summarize(telemetry_t *telemetry) {
+    static uint64_t frame_ticks[TELEMETRY_FRAMES];
+    uint64_t stage_ticks[STAGE_COUNT] = {0};
+    uint64_t instructions = 0;
+    int64_t oversleep_ticks = 0;
+    const uint64_t now = SDL_GetPerformanceCounter();
+    const double ms_per_tick = 1000.0 / telemetry->frequency;
+    const double elapsed = (double)(now - telemetry->summary_start) / telemetry->frequency;
+    const uint32_t window = telemetry->frame_count - telemetry->summary_frame_start;
+    const uint32_t logged = telemetry->frame_count < TELEMETRY_FRAMES ? telemetry->frame_count : TELEMETRY_FRAMES;
+    telemetry_summary_t *summary = &telemetry->summary;
+
+    for (uint32_t i = 0; i < window; i++) {
+        const frame_record_t *record = &telemetry->frames[(telemetry->frame_count - 1 - i) & (TELEMETRY_FRAMES - 1)];
+
+        instructions += record->instructions;
+        oversleep_ticks += (int64_t)record->stage_ticks[STAGE_SLEEP] - (int64_t)record->requested_sleep_ticks;
+        for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+            stage_ticks[s] += record->stage_ticks[s];
+        }
+    }
+    for (uint32_t i = 0; i < logged; i++) {
+        frame_ticks[i] = telemetry->frames[i].frame_ticks;
+    }
+    qsort(frame_ticks, logged, sizeof(frame_ticks[0]), compare_ticks);
+
+    summary->ips = instructions / elapsed;
+    summary->fps = window / elapsed;
+    summary->frame_ms_p50 = frame_ticks[logged * 50 / 100] * ms_per_tick;
+    summary->frame_ms_p95 = frame_ticks[logged * 95 / 100] * ms_per_tick;
+    summary->frame_ms_p99 = frame_ticks[logged * 99 / 100] * ms_per_tick;
+    summary->frame_ms_max = frame_ticks[logged - 1] * ms_per_tick;
+    summary->oversleep_ms_avg = oversleep_ticks * ms_per_tick / window;
+    for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+        summary->stage_ms_avg[s] = stage_ticks[s] * ms_per_tick / window;
+    }
+    summary->audio_late_callbacks = atomic_load_explicit(&audio_late_callbacks, memory_order_relaxed);
+
+    telemetry_restart_summary(telemetry);
+}
+
+/* Starts a new summary window now; called after a pause so the paused time isn't counted against FPS/IPS */
+void telemetry_restart_summary(telemetry_t *telemetry) {
+    telemetry->summary_start = SDL_GetPerformanceCounter();
+    telemetry->summary_frame_start = telemetry->frame_count;
+}
+
+/* Closes out the current frame: stores it in the ring, appends it to the CSV and refreshes the summary */
+void telemetry_end_frame(telemetry_t *telemetry, uint32_t instructions) {
+    frame_record_t *record = &telemetry->frames[telemetry->frame_count & (TELEMETRY_FRAMES - 1)];
+    const double ms_per_tick = 1000.0 / telemetry->frequency;
+
+    record->frame_ticks = SDL_GetPerformanceCounter() - telemetry->frame_start;
+    record->instructions = instructions;
+    record->audio_late_callbacks = atomic_load_explicit(&audio_late_callbacks, memory_order_relaxed);
+
+    if (telemetry->csv != NULL) {
+        fprintf(telemetry->csv, "%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u\n",
+            (unsigned long long)telemetry->frame_count, record->frame_ticks * ms_per_tick,
+            record->stage_ticks[STAGE_INPUT] * ms_per_tick, record->stage_ticks[STAGE_EXECUTE] * ms_per_tick,
+            record->stage_ticks[STAGE_SLEEP] * ms_per_tick, record->requested_sleep_ticks * ms_per_tick,
+            record->stage_ticks[STAGE_RUN_AHEAD] * ms_per_tick, record->stage_ticks[STAGE_RENDER] * ms_per_tick,
+            record->stage_ticks[STAGE_TIMERS] * ms_per_tick,
+            record->instructions, record->audio_late_callbacks);
+    }
+
+    if (++telemetry->frame_count - telemetry->summary_frame_start >= TELEMETRY_SUMMARY_FRAMES) {
+        summarize(telemetry);
+    }
+}
+
+/* Called from the audio callback; counts callbacks that arrive more than a buffer late.
+   Gaps over 100ms are the device being paused between beeps, not underruns */
+void telemetry_audio_callback(int samples, int sample_rate) {
+    const uint64_t now = SDL_GetPerformanceCounter();
+    const uint64_t frequency = SDL_GetPerformanceFrequency();
+    const uint64_t gap = now - last_audio_callback;
+
+    if (last_audio_callback != 0 && gap > 2 * (uint64_t)samples * frequency / sample_rate && gap < frequency / 10) {
+        atomic_fetch_add_explicit(&audio_late_callbacks, 1, memory_order_relaxed);
+    }
+    last_audio_callback = now;
+}
+
+/* Appends the rects for one line of overlay text; unknown characters are drawn as spaces */
+static int add_text(SDL_Rect *rects, int count, const char *text, int x, int y) {
+    for (; *text != '\0'; text++, x += 4 * OVERLAY_SCALE) {
+        for (size_t g = 0; g < sizeof(glyphs) / sizeof(glyphs[0]); g++) {
+            if (glyphs[g].c != *text) {
+                continue;
+            }
+            for (int row = 0; row < 5; row++) {
+                for (int col = 0; col < 3; col++) {
+                    if (glyphs[g].rows[row] & (4 >> col)) {
+                        rects[count++] = (SDL_Rect){x + col * OVERLAY_SCALE, y + row * OVERLAY_SCALE,
+                            OVERLAY_SCALE, OVERLAY_SCALE};
+                    }
+                }
+            }
+            break;
+        }
+    }
+    return count;
+}
+
+/* Draws the latest summary in the top-left corner; Must be called before SDL_RenderPresent */
+void telemetry_draw(const telemetry_t *telemetry, SDL_Renderer *renderer) {
+    static SDL_Rect rects[OVERLAY_LINES * OVERLAY_LINE_CHARS * 15];
+    char lines[OVERLAY_LINES][OVERLAY_LINE_CHARS + 1];
+    const telemetry_summary_t *summary = &telemetry->summary;
+    int count = 0;
+
+    if (!telemetry->overlay) {
+        return;
+    }
+
+    snprintf(lines[0], sizeof(lines[0]), "FPS %.1f IPS %.0f", summary->fps, summary->ips);
+    snprintf(lines[1], sizeof(lines[1]), "P50 %.2f P95 %.2f P99 %.2f MAX %.2f",
+        summary->frame_ms_p50, summary->frame_ms_p95, summary->frame_ms_p99, summary->frame_ms_max);
+    snprintf(lines[2], sizeof(lines[2]), "IN %.2f EX %.2f SL %.2f RA %.2f RN %.2f TM %.2f",
+        summary->stage_ms_avg[STAGE_INPUT], summary->stage_ms_avg[STAGE_EXECUTE], summary->stage_ms_avg[STAGE_SLEEP],
+        summary->stage_ms_avg[STAGE_RUN_AHEAD], summary->stage_ms_avg[STAGE_RENDER], summary->stage_ms_avg[STAGE_TIMERS]);
+    snprintf(lines[3], sizeof(lines[3]), "OVERSLEEP %.2f AUDIO LATE %u",
+        summary->oversleep_ms_avg, summary->audio_late_callbacks);
+
+    for (int i = 0; i < OVERLAY_LINES; i++) {
+        count = add_text(rects, count, lines[i], 2 * OVERLAY_SCALE, (2 + i * 7) * OVERLAY_SCALE);
+    }
+
+    // Background box behind the text, then the text itself
+    const SDL_Rect box = {0, 0, (OVERLAY_LINE_CHARS * 4 + 4) * OVERLAY_SCALE, (OVERLAY_LINES * 7 + 2) * OVERLAY_SCALE};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderFillRect(renderer, &box);
+    SDL_SetRenderDrawColor(renderer, 255, 214, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderFillRects(renderer, rects, count);
+}
+
+/* Flushes and closes the CSV log */
+void telemetry_close(telemetry_t *telemetry) {
+    if (telemetry->csv != NULL) {
+        fclose(telemetry->csv);
+        telemetry->csv = NULL;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <SDL.h>
+
+#define TELEMETRY_FRAMES 512        // Frames kept in the ring log; must be a power of 2
+#define TELEMETRY_SUMMARY_FRAMES 60 // Rates and averages are recomputed once per this many frames
+
+/* Stages of one pass through the main loop, in the order they run */
+typedef enum {
+    STAGE_INPUT,
+    STAGE_EXECUTE,
+    STAGE_SLEEP,
+    STAGE_RUN_AHEAD,
+    STAGE_RENDER,
+    STAGE_TIMERS,
+    STAGE_COUNT,
+} telemetry_stage;
+
+/* Timing for one frame; all durations are in performance counter ticks */
+typedef struct {
+    uint64_t stage_ticks[STAGE_COUNT];
+    uint64_t frame_ticks;           // Start of input to end of timer update
+    uint64_t requested_sleep_ticks; // What was asked of SDL_Delay; compare with stage_ticks[STAGE_SLEEP]
+    uint32_t instructions;          // Instructions executed this frame
+    uint32_t audio_late_callbacks;  // Running total of audio callbacks that arrived too late (likely underruns)
+} frame_record_t;
+
+/* Derived statistics, refreshed every TELEMETRY_SUMMARY_FRAMES frames */
+typedef struct {
+    double ips;                     // Achieved instructions per second
+    double fps;
+    double frame_ms_p50, frame_ms_p95, frame_ms_p99, frame_ms_max;
+    double stage_ms_avg[STAGE_COUNT];
+    double oversleep_ms_avg;        // How much longer SDL_Delay took than requested
+    uint32_t audio_late_callbacks;
+} telemetry_summary_t;
+
+typedef struct {
+    frame_record_t frames[TELEMETRY_FRAMES]; // Ring log of the most recent frames
+    uint64_t frame_count;                    // Total frames recorded; next slot is frame_count % TELEMETRY_FRAMES
+    uint64_t frame_start;
+    uint64_t stage_start;
+    uint64_t frequency;
+    uint64_t summary_start;                  // Counter value when the current summary window began
+    uint64_t summary_frame_start;            // frame_count when the current summary window began
+    telemetry_summary_t summary;
+    FILE *csv;                               // Every frame is appended here if a CSV path was given
+    bool overlay;                            // Draw summary on top of the display; toggled with F1
+} telemetry_t;
+
+bool telemetry_init(telemetry_t *telemetry, const char csv_path[]);
+void telemetry_begin_frame(telemetry_t *telemetry);
+void telemetry_end_stage(telemetry_t *telemetry, telemetry_stage stage);
+void telemetry_requested_sleep(telemetry_t *telemetry, uint32_t ms);
+void telemetry_end_frame(telemetry_t *telemetry, uint32_t instructions);
+void telemetry_restart_summary(telemetry_t *telemetry);
+void telemetry_audio_callback(int samples, int sample_rate);
+void telemetry_draw(const telemetry_t *telemetry, SDL_Renderer *renderer);
+void telemetry_close(telemetry_t *telemetry);
+
+#endif
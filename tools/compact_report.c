@@ -0,0 +1,77 @@
+/* Reports how small compact_chip8_t instances are for real ROMs.
+
+   Usage: ./compact_report <ROM/PATH.ch8>...
+
+   Each ROM is run for a few seconds of emulated time with scripted keypad
+   input, then packed against its freshly loaded RAM image. The image is shared
+   by every instance of that ROM, so it is reported once, not per instance. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../chip8.h"
+#include "../compact.h"
+
+#define FRAMES 600              // 10 seconds of emulated time
+#define FRAMES_PER_KEY 30       // Each key is held for half a second in turn
+
+/* Returns a cache size from sysconf where available, otherwise a typical desktop value */
+static long cache_size(int level) {
+#if defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+    const long size = sysconf(level == 2 ? _SC_LEVEL2_CACHE_SIZE : _SC_LEVEL3_CACHE_SIZE);
+    if (size > 0) {
+        return size;
+    }
+#endif
+    return level == 2 ? 1024 * 1024 : 32 * 1024 * 1024;
+}
+
+int main(int argc, char *argv[]) {
+    static chip8_t chip8, check;
+    uint8_t shared_image[RAM_SIZE];
+    compact_chip8_t *compact = NULL;
+    const long l2 = cache_size(2), l3 = cache_size(3);
+
+    if (argc < 2) {
+        printf("Usage: ./compact_report <ROM/PATH.ch8>...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("chip8_t: %zu bytes, compact fixed part: %zu bytes, L2: %ld KB, L3: %ld KB\n\n",
+        sizeof(chip8_t), sizeof(compact_chip8_t), l2 / 1024, l3 / 1024);
+    printf("%-28s %8s %8s %12s %12s\n", "ROM", "pages", "bytes", "per L2", "per L3");
+
+    for (int a = 1; a < argc; a++) {
+        if (!initialize_chip8(&chip8, argv[a])) {
+            continue;
+        }
+        memcpy(shared_image, chip8.ram, sizeof(shared_image));
+
+        for (uint32_t frame = 0; frame < FRAMES && chip8.state != QUIT; frame++) {
+            memset(chip8.keypad, false, sizeof(chip8.keypad));
+            chip8.keypad[(frame / FRAMES_PER_KEY) % sizeof(chip8.keypad)] = true;
+            run_frame(&chip8);
+        }
+
+        compact = compact_pack(&chip8, shared_image, compact);
+        if (compact == NULL) {
+            printf("Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Make sure nothing was lost in packing. Both structs start zeroed (static, and reset_chip8's memset),
+        // so padding matches and the whole struct can be compared; this catches fields missing from the packing
+        compact_unpack(&check, compact, shared_image);
+        if (memcmp(&check, &chip8, sizeof(chip8)) != 0) {
+            printf("%s: unpacked state does not match\n", argv[a]);
+            exit(EXIT_FAILURE);
+        }
+
+        const size_t bytes = compact_size(compact);
+        printf("%-28.28s %8d %8zu %12zu %12zu\n", argv[a], __builtin_popcount(compact->private_pages),
+            bytes, l2 / bytes, l3 / bytes);
+    }
+
+    free(compact);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,241 @@
+/* Runs one ROM under every combination of quirk_flags in parallel and reports
+   which combinations behave the same, which crash, and which profile to use.
+
+   Usage: ./quirk_sweep <ROM/PATH.ch8> [FRAMES] [INPUT_SCRIPT] [THREADS]
+
+   Every run starts from the same state and RNG seed and gets the same
+   scripted keypad input, so any difference between runs comes from the
+   quirks alone. The input script has one "FRAME KEYMASK" pair per line
+   (decimal frame, hex keypad bitmask held from that frame on). Without a
+   script, each key is held for 20 frames in turn with 10-frame gaps. */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../chip8.h"
+
+#define COMBINATIONS (1 << QUIRK_COUNT)
+#define DEFAULT_FRAMES 1800     // 30 seconds of emulated time
+#define MAX_SCRIPT_LINES 1024
+
+typedef struct {
+    uint32_t frame;
+    uint16_t mask;
+} script_line_t;
+
+typedef struct {
+    uint64_t hash;              // FNV-1a of display and RAM at the end of the run
+    emu_fault fault;
+    uint32_t fault_frame;
+} sweep_result_t;
+
+static chip8_t initial;
+static script_line_t script[MAX_SCRIPT_LINES];
+static uint32_t script_length;
+static uint32_t frames = DEFAULT_FRAMES;
+static sweep_result_t results[COMBINATIONS];
+static atomic_uint next_combination;
+
+/* Keypad bitmask to hold during frame */
+static uint16_t input_for_frame(uint32_t frame) {
+    uint16_t mask = 0;
+
+    if (script_length == 0) {
+        return (frame % 30) < 20 ? 1 << ((frame / 30) % 16) : 0;
+    }
+    for (uint32_t i = 0; i < script_length && script[i].frame <= frame; i++) {
+        mask = script[i].mask;
+    }
+    return mask;
+}
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+/* Worker: claims quirk combinations until none are left */
+static void *sweep_worker(void *arg) {
+    chip8_t chip8;
+    (void)arg;
+
+    for (uint32_t quirks; (quirks = atomic_fetch_add(&next_combination, 1)) < COMBINATIONS; ) {
+        sweep_result_t *result = &results[quirks];
+
+        memcpy(&chip8, &initial, sizeof(chip8));
+        chip8.quirks = quirks;
+
+        for (uint32_t frame = 0; frame < frames && chip8.state != QUIT; frame++) {
+            const uint16_t mask = input_for_frame(frame);
+            for (uint8_t k = 0; k < sizeof(chip8.keypad); k++) {
+                chip8.keypad[k] = (mask >> k) & 1;
+            }
+            run_frame(&chip8);
+            result->fault_frame = frame;
+        }
+
+        result->fault = chip8.fault;
+        result->hash = fnv1a(fnv1a(0xCBF29CE484222325ULL, chip8.display, sizeof(chip8.display)), chip8.ram, sizeof(chip8.ram));
+    }
+    return NULL;
+}
+
+static bool load_script(const char path[]) {
+    FILE *file = fopen(path, "r");
+    unsigned int frame, mask;
+
+    if (file == NULL) {
+        printf("Input script %s does not exist\n", path);
+        return false;
+    }
+    while (script_length < MAX_SCRIPT_LINES && fscanf(file, "%u %x", &frame, &mask) == 2) {
+        script[script_length++] = (script_line_t){frame, mask};
+    }
+    fclose(file);
+    return true;
+}
+
+static void print_quirks(uint32_t quirks) {
+    printf("0x%02X", quirks);
+    for (uint8_t q = 0; q < QUIRK_COUNT; q++) {
+        if (quirks & (1 << q)) {
+            printf(" %s", quirk_name(1 << q));
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    pthread_t threads[COMBINATIONS];
+    uint32_t thread_count = 4;
+    bool done[COMBINATIONS] = {false};
+    uint32_t cluster_of[COMBINATIONS];          // First member of the cluster each combination landed in
+    uint32_t representatives[COMBINATIONS];     // Best clusters, by their member with the fewest quirks set
+    uint32_t best_count = 0, best_size = 0;
+
+    if (argc < 2 || argc > 5) {
+        printf("Usage: ./quirk_sweep <ROM/PATH.ch8> [FRAMES] [INPUT_SCRIPT] [THREADS]\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!initialize_chip8(&initial, argv[1])) {
+        exit(EXIT_FAILURE);
+    }
+    if (argc > 2) {
+        frames = strtoul(argv[2], NULL, 10);
+    }
+    if (argc > 3 && strcmp(argv[3], "-") != 0 && !load_script(argv[3])) {
+        exit(EXIT_FAILURE);
+    }
+#ifdef _SC_NPROCESSORS_ONLN
+    thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (argc > 4) {
+        thread_count = strtoul(argv[4], NULL, 10);
+    }
+    thread_count = thread_count < 1 ? 1 : thread_count > COMBINATIONS ? COMBINATIONS : thread_count;
+
+    for (uint32_t t = 0; t < thread_count; t++) {
+        pthread_create(&threads[t], NULL, sweep_worker, NULL);
+    }
+    for (uint32_t t = 0; t < thread_count; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    printf("%s: %d quirk combinations, %u frames, %u threads\n\n", argv[1], COMBINATIONS, frames, thread_count);
+
+    // Crashes first; these combinations are almost certainly wrong for this ROM
+    for (uint32_t c = 0; c < COMBINATIONS; c++) {
+        if (results[c].fault != NO_FAULT) {
+            printf("CRASH at frame %u (%s): ", results[c].fault_frame, fault_name(results[c].fault));
+            print_quirks(c);
+            done[c] = true;
+        }
+    }
+
+    // Cluster the rest by final state. Each cluster is represented by its member with the fewest quirks set
+    for (uint32_t c = 0; c < COMBINATIONS; c++) {
+        uint32_t size = 0, representative = c;
+
+        if (done[c]) {
+            continue;
+        }
+        printf("\nCluster %016llx:\n", (unsigned long long)results[c].hash);
+        for (uint32_t other = c; other < COMBINATIONS; other++) {
+            if (!done[other] && results[other].hash == results[c].hash) {
+                printf("  ");
+                print_quirks(other);
+                done[other] = true;
+                cluster_of[other] = c;
+                size++;
+                if (__builtin_popcount(other) < __builtin_popcount(representative)) {
+                    representative = other;
+                }
+            }
+        }
+
+        // Prefer the biggest cluster: it is the behavior the most interpreter variants agree on,
+        // and the quirks that vary inside it are the ones this ROM doesn't care about
+        if (size > best_size) {
+            best_count = 0;
+            best_size = size;
+        }
+        if (size == best_size) {
+            representatives[best_count++] = representative;
+        }
+    }
+
+    // A quirk matters if toggling it changes the outcome of at least one combination
+    printf("\nQuirks that change this ROM's behavior:");
+    for (uint8_t q = 0; q < QUIRK_COUNT; q++) {
+        for (uint32_t c = 0; c < COMBINATIONS; c++) {
+            const uint32_t toggled = c ^ (1 << q);
+            if (results[c].hash != results[toggled].hash || results[c].fault != results[toggled].fault) {
+                printf(" %s", quirk_name(1 << q));
+                break;
+            }
+        }
+    }
+    printf("\n");
+
+    if (best_count == 0) {
+        printf("\nEvery combination crashed; no profile to recommend\n");
+        exit(EXIT_FAILURE);
+    }
+    if (best_count == 1) {
+        printf("\nRecommended profile (run with --quirks %X): ", representatives[0]);
+        print_quirks(representatives[0]);
+        exit(EXIT_SUCCESS);
+    }
+
+    // A tie usually means one quirk splits the combinations evenly and the sweep can't tell which
+    // side is right (e.g. shift-vy or display-wait); name the quirks that separate the tied clusters
+    printf("\nAmbiguous: %u behaviors tie with %u combinations each; check which one looks right\n", best_count, best_size);
+    printf("Deciding quirks:");
+    bool any_deciding = false;
+    for (uint8_t q = 0; q < QUIRK_COUNT; q++) {
+        bool deciding = true;
+        for (uint32_t c = 0; c < COMBINATIONS && deciding; c++) {
+            const uint32_t toggled = c ^ (1 << q);
+            // Toggling q must always change the outcome, whatever the other quirks are
+            deciding = results[c].fault == NO_FAULT && results[toggled].fault == NO_FAULT &&
+                cluster_of[c] != cluster_of[toggled];
+        }
+        if (deciding) {
+            printf(" %s", quirk_name(1 << q));
+            any_deciding = true;
+        }
+    }
+    printf(any_deciding ? "\n" : " none on their own\n");
+    for (uint32_t i = 0; i < best_count; i++) {
+        printf("  --quirks %X: ", representatives[i]);
+        print_quirks(representatives[i]);
+    }
+
+    exit(EXIT_SUCCESS);
+}